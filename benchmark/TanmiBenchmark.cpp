@@ -0,0 +1,349 @@
+/*****************************************************************//**
+ * \file   TanmiBenchmark.cpp
+ * \brief  事件系统、消息队列与时钟的微基准测试，结果以JSON输出
+ *
+ * 用法：TanmiBenchmark [--out 文件路径] [--filter 名称片段]
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "TanmiEventSystem.hpp"
+#include "TanmiClock.hpp"
+
+using namespace TanmiEngine;
+using BenchClock = std::chrono::steady_clock;
+
+namespace
+{
+	/**
+	 * @brief 单项测试结果
+	 */
+	struct BenchResult
+	{
+		std::string name;										///< 测试名称
+		std::vector<std::pair<std::string, double>> params;		///< 参数
+		std::vector<std::pair<std::string, double>> metrics;	///< 结果
+
+		std::string ToJson() const
+		{
+			auto object = [](const std::vector<std::pair<std::string, double>>& values)
+				{
+					std::ostringstream ss;
+					ss << "{";
+					for (size_t i = 0; i < values.size(); ++i)
+						ss << (i ? "," : "") << "\"" << values[i].first << "\":" << values[i].second;
+					ss << "}";
+					return ss.str();
+				};
+			return "{\"name\":\"" + name + "\",\"params\":" + object(params) + ",\"metrics\":" + object(metrics) + "}";
+		}
+	};
+
+	std::vector<BenchResult> results;	//< 所有测试结果
+	std::string filter;					//< 仅运行名称包含该片段的测试
+
+	/**
+	 * @brief 是否运行指定测试
+	 */
+	bool enabled(const char* name)
+	{
+		return filter.empty() || std::strstr(name, filter.c_str()) != nullptr;
+	}
+
+	/**
+	 * @brief 计算两个时刻之间的纳秒数
+	 */
+	double elapsedNs(BenchClock::time_point begin, BenchClock::time_point end)
+	{
+		return std::chrono::duration<double, std::nano>(end - begin).count();
+	}
+
+	/**
+	 * @brief 空监听器
+	 */
+	class NullListener : public Listener
+	{
+	public:
+		virtual void WakeEvent(const EventID event)
+		{}
+		virtual void WakeEventUpdate(const EventID event, double ms)
+		{}
+	};
+
+	/**
+	 * @brief 记录触发至唤醒延迟的监听器
+	 */
+	class LatencyListener : public Listener
+	{
+	public:
+		virtual void WakeEvent(const EventID event)
+		{
+			latency.Record((unsigned long long)elapsedNs(BenchClock::time_point(BenchClock::duration(sent.load(std::memory_order_acquire))), BenchClock::now()));
+			done.store(true, std::memory_order_release);
+		}
+		virtual void WakeEventUpdate(const EventID event, double ms)
+		{}
+		std::atomic<BenchClock::rep> sent{ 0 };	///< 触发时刻
+		std::atomic<bool> done{ false };		///< 是否已唤醒
+		Histogram latency;						///< 延迟直方图（纳秒）
+	};
+
+	/**
+	 * @brief 丢弃所有输出的流缓冲区，用于屏蔽无监听器事件的异常输出
+	 */
+	class NullBuffer : public std::streambuf
+	{
+	protected:
+		virtual int overflow(int c)
+		{
+			return c;
+		}
+	};
+
+	/**
+	 * @brief TriggerEvent 的调用开销，消息处理器不启动处理线程，触发后统一清空队列且不计时
+	 */
+	void benchTrigger(EventSystem& eventSystem, std::shared_ptr<MessageHandler> handler)
+	{
+		for (int subscribers : { 0, 1, 100, 10000 })
+		{
+			auto event = eventSystem.NewAndRegisterEvent<Event>();
+			std::vector<std::shared_ptr<NullListener>> listeners;
+			for (int i = 0; i < subscribers; ++i)
+			{
+				listeners.push_back(std::make_shared<NullListener>());
+				eventSystem.AddEventHandler(*event, listeners.back());
+			}
+			int rounds = subscribers >= 10000 ? 50 : subscribers >= 100 ? 5000 : 100000;
+			NullBuffer null;
+			auto old = std::cout.rdbuf(&null);
+			double total = 0;
+			for (int r = 0; r < rounds; ++r)
+			{
+				auto begin = BenchClock::now();
+				eventSystem.TriggerEvent(*event);
+				total += elapsedNs(begin, BenchClock::now());
+				handler->Poll();
+			}
+			eventSystem.RemoveAllEventForEventName(*event);
+			std::cout.rdbuf(old);
+			results.push_back({ "trigger", { { "subscribers", subscribers } },
+				{ { "ns_per_trigger", total / rounds }, { "ns_per_subscriber", subscribers ? total / rounds / subscribers : 0 } } });
+		}
+	}
+
+	/**
+	 * @brief 大量监听器的绑定与移除
+	 */
+	void benchSubscribe(EventSystem& eventSystem)
+	{
+		for (int count : { 1000, 10000 })
+		{
+			auto event = eventSystem.NewAndRegisterEvent<Event>();
+			std::vector<std::shared_ptr<NullListener>> listeners(count);
+			for (auto& l : listeners)
+				l = std::make_shared<NullListener>();
+			auto begin = BenchClock::now();
+			for (auto& l : listeners)
+				eventSystem.AddEventHandler(*event, l);
+			auto mid = BenchClock::now();
+			for (auto& l : listeners)
+				eventSystem.RemoveAllEventForListener(l);
+			auto end = BenchClock::now();
+			results.push_back({ "subscribe", { { "listeners", count } },
+				{ { "add_ns_per_listener", elapsedNs(begin, mid) / count }, { "remove_all_ns_per_listener", elapsedNs(mid, end) / count } } });
+		}
+	}
+
+	/**
+	 * @brief MessageQueue 多生产者单消费者吞吐
+	 */
+	void benchQueue()
+	{
+		const int total = 1 << 20;
+		for (int producers : { 1, 2, 4, 8, 16, 32, 64 })
+		{
+			MessageQueue<int> queue;
+			int per = total / producers;
+			std::atomic<bool> start{ false };
+			std::vector<std::thread> threads;
+			for (int p = 0; p < producers; ++p)
+			{
+				threads.emplace_back([&]()
+					{
+						while (!start.load(std::memory_order_acquire));
+						for (int i = 0; i < per; ++i)
+							queue.Push(i);
+					});
+			}
+			auto begin = BenchClock::now();
+			start.store(true, std::memory_order_release);
+			for (int i = 0; i < per * producers; ++i)
+				queue.Pop();
+			auto end = BenchClock::now();
+			for (auto& t : threads)
+				t.join();
+			double ns = elapsedNs(begin, end);
+			results.push_back({ "queue_mpsc", { { "producers", producers } },
+				{ { "ns_per_message", ns / (per * producers) }, { "messages_per_sec", (per * producers) / ns * 1e9 } } });
+		}
+	}
+
+	/**
+	 * @brief 不同消息频率下，各等待策略的入队至出队延迟
+	 */
+	void benchQueueWakeup()
+	{
+		struct Policy
+		{
+			const char* name;
+			QueueWaitPolicy policy;
+		};
+		const Policy policies[] = {
+			{ "park", QueueWaitPolicy{ 0, 0, false } },
+			{ "spin", QueueWaitPolicy{ 20000, 100, false } },
+			{ "adaptive", QueueWaitPolicy{ 20000, 100, true } },
+		};
+		for (auto& p : policies)
+		{
+			for (int interval_us : { 2, 20, 200, 2000 })
+			{
+				MessageQueue<BenchClock::rep> queue;
+				queue.SetWaitPolicy(p.policy);
+				int count = (std::min)(20000, 200000 / interval_us);
+				Histogram latency;
+				std::thread consumer([&]()
+					{
+						for (int i = 0; i < count; ++i)
+						{
+							auto sent = queue.Pop();
+							latency.Record((unsigned long long)elapsedNs(BenchClock::time_point(BenchClock::duration(sent)), BenchClock::now()));
+						}
+					});
+				auto next = BenchClock::now();
+				for (int i = 0; i < count; ++i)
+				{
+					next += std::chrono::microseconds(interval_us);
+					std::this_thread::sleep_until(next);
+					queue.Push(BenchClock::now().time_since_epoch().count());
+				}
+				consumer.join();
+				auto snapshot = latency.Snapshot();
+				results.push_back({ std::string("queue_wakeup_") + p.name, { { "interval_us", interval_us }, { "messages", count } },
+					{ { "mean_ns", snapshot.Mean() }, { "p50_ns", (double)snapshot.Percentile(50) }, { "p99_ns", (double)snapshot.Percentile(99) },
+					{ "max_ns", (double)snapshot.max }, { "spin_window", (double)queue.GetSpinWindow() } } });
+			}
+		}
+	}
+
+	/**
+	 * @brief 无负载时触发至 WakeEvent 的端到端延迟，逐条触发并等待唤醒
+	 */
+	void benchLatency(EventSystem& eventSystem)
+	{
+		auto handler = std::make_shared<MessageHandler>();
+		eventSystem.RegisterMessageHandler(handler);
+		auto event = eventSystem.NewAndRegisterEvent<Event>();
+		auto listener = std::make_shared<LatencyListener>();
+		eventSystem.AddEventHandler(*event, listener);
+		const int rounds = 20000;
+		for (int r = 0; r < rounds; ++r)
+		{
+			listener->done.store(false, std::memory_order_relaxed);
+			listener->sent.store(BenchClock::now().time_since_epoch().count(), std::memory_order_release);
+			eventSystem.TriggerEvent(*event);
+			while (listener->done.load(std::memory_order_acquire) == false);
+		}
+		auto snapshot = listener->latency.Snapshot();
+		results.push_back({ "trigger_to_wake", { { "rounds", rounds } },
+			{ { "mean_ns", snapshot.Mean() }, { "p50_ns", (double)snapshot.Percentile(50) }, { "p90_ns", (double)snapshot.Percentile(90) },
+			{ "p99_ns", (double)snapshot.Percentile(99) }, { "p999_ns", (double)snapshot.Percentile(99.9) }, { "max_ns", (double)snapshot.max } } });
+		eventSystem.RemoveAllEventForEventName(*event);
+		handler->Shutdown();
+	}
+
+	/**
+	 * @brief Clock::GetUpdate 的轮询开销（内部调用 isUpdate）
+	 */
+	void benchClock()
+	{
+		Clock& clock = Clock::Instance();
+		for (int count : { 1, 100, 10000, 100000 })
+		{
+			std::vector<ClockID> clocks;
+			for (int i = 0; i < count; ++i)
+				clocks.push_back(clock.NewClock(60));
+			int rounds = count >= 10000 ? 10 : count >= 100 ? 1000 : 100000;
+			int updates = 0;
+			auto begin = BenchClock::now();
+			for (int r = 0; r < rounds; ++r)
+			{
+				for (auto id : clocks)
+					updates += clock.GetUpdate(id);
+			}
+			double ns = elapsedNs(begin, BenchClock::now());
+			results.push_back({ "clock_get_update", { { "clocks", count } },
+				{ { "ns_per_call", ns / ((double)rounds * count) }, { "updates", (double)updates } } });
+			for (auto id : clocks)
+				clock.EraseClock(id);
+		}
+	}
+}
+
+auto main(int argc, char** argv) -> int
+{
+	std::string out;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+			out = argv[++i];
+		else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+	}
+
+	EventSystem& eventSystem = EventSystem::Instance();
+	auto handler = std::make_shared<MessageHandler>();
+	eventSystem.RegisterMessageHandler(handler, false);
+	eventSystem.RegisterMessageHandlerUpdate(std::make_shared<MessageHandlerUpdate>(), false);
+
+	if (enabled("trigger"))
+		benchTrigger(eventSystem, handler);
+	if (enabled("subscribe"))
+		benchSubscribe(eventSystem);
+	if (enabled("queue"))
+		benchQueue();
+	if (enabled("wakeup"))
+		benchQueueWakeup();
+	if (enabled("latency"))
+		benchLatency(eventSystem);
+	if (enabled("clock"))
+		benchClock();
+
+	std::string json = "{\"benchmarks\":[";
+	for (size_t i = 0; i < results.size(); ++i)
+		json += (i ? ",\n" : "\n") + results[i].ToJson();
+	json += "\n]}\n";
+	if (out.empty())
+	{
+		std::cout << json;
+	}
+	else
+	{
+		std::ofstream file(out);
+		file << json;
+		std::cerr << "results written to " << out << std::endl;
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,703 @@
+/*****************************************************************//**
+ * \file   TanmiCheck.cpp
+ * \brief  行为自检：稳定运行后热路径的全局分配次数、批量触发、事件路由、多线程同步与虚拟时间下的时钟更新，任一检查失败时返回非0
+ *
+ * 用法：TanmiCheck [--filter 名称片段]
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TanmiEventSystem.hpp"
+#include "TanmiClock.hpp"
+#include "TanmiMemory.hpp"
+
+using namespace TanmiEngine;
+
+TANMI_EVENT(CheckStaticEvent);
+
+namespace
+{
+	std::atomic<unsigned long long> globalAllocations{ 0 };	//< 全局分配器的调用次数
+
+	/**
+	 * @brief 从全局分配器分配内存并计数
+	 */
+	void* countedAlloc(std::size_t size, std::size_t align)
+	{
+		globalAllocations.fetch_add(1, std::memory_order_relaxed);
+		if (size == 0)
+			size = 1;
+		void* p = align > alignof(std::max_align_t) ? std::aligned_alloc(align, (size + align - 1) / align * align) : std::malloc(size);
+		if (p == nullptr)
+			throw std::bad_alloc();
+		return p;
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	return countedAlloc(size, 0);
+}
+void* operator new[](std::size_t size)
+{
+	return countedAlloc(size, 0);
+}
+void* operator new(std::size_t size, std::align_val_t align)
+{
+	return countedAlloc(size, (std::size_t)align);
+}
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+	return countedAlloc(size, (std::size_t)align);
+}
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+
+namespace
+{
+	// 池资源须在事件系统单例之前构造，使其在单例之后析构
+	EventPoolResource pool;		//< 分配检查使用的池资源
+
+	std::string filter;			//< 仅运行名称包含该片段的检查
+	int failures = 0;			//< 失败的检查数量
+
+	/**
+	 * @brief 是否运行指定检查
+	 */
+	bool enabled(const char* name)
+	{
+		return filter.empty() || std::strstr(name, filter.c_str()) != nullptr;
+	}
+
+	/**
+	 * @brief 输出检查结果
+	 */
+	void report(const char* name, bool passed, const std::string& detail)
+	{
+		if (passed == false)
+			++failures;
+		std::cout << (passed ? "[PASS] " : "[FAIL] ") << name << ": " << detail << std::endl;
+	}
+
+	/**
+	 * @brief 计数监听器
+	 */
+	class CountListener : public Listener
+	{
+	public:
+		virtual void WakeEvent(const EventID event)
+		{
+			++count;
+		}
+		virtual void WakeEventUpdate(const EventID event, double ms)
+		{
+			++count;
+		}
+		unsigned long long count = 0;	///< 唤醒次数
+	};
+
+	/**
+	 * @brief 记录每次批量唤醒所收到事件的监听器
+	 */
+	class BatchRecordListener : public Listener
+	{
+	public:
+		virtual void WakeEvent(const EventID event)
+		{
+			batches.push_back({ event });
+		}
+		virtual void WakeEventUpdate(const EventID event, double ms)
+		{
+			batches.push_back({ event });
+		}
+		virtual void WakeEventBatch(std::span<const EventID> events)
+		{
+			batches.emplace_back(events.begin(), events.end());
+		}
+		std::vector<std::vector<EventID>> batches;	///< 各次唤醒收到的事件
+	};
+
+	/**
+	 * @brief 处理耗时固定的监听器，可被多个处理线程并发唤醒
+	 */
+	class SlowListener : public Listener
+	{
+	public:
+		explicit SlowListener(std::atomic<int>& _ran) :ran(_ran)
+		{}
+		virtual void WakeEvent(const EventID event)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+			ran.fetch_add(1, std::memory_order_release);
+		}
+		virtual void WakeEventUpdate(const EventID event, double ms)
+		{
+			WakeEvent(event);
+		}
+	private:
+		std::atomic<int>& ran;	//< 所有监听器共享的完成计数
+	};
+
+	/**
+	 * @brief 可被并发唤醒的计数监听器
+	 */
+	class AtomicCountListener : public Listener
+	{
+	public:
+		virtual void WakeEvent(const EventID event)
+		{
+			count.fetch_add(1, std::memory_order_relaxed);
+		}
+		virtual void WakeEventUpdate(const EventID event, double ms)
+		{
+			count.fetch_add(1, std::memory_order_relaxed);
+		}
+		std::atomic<unsigned long long> count{ 0 };	///< 唤醒次数
+	};
+
+	/**
+	 * @brief 使用 EventPoolResource 时，稳定运行后单个触发、批量触发（排序与订阅位矩阵两种路径，含按管线拆分）
+	 * 与消息分发（含合并投递）不再调用全局分配器
+	 */
+	void checkPoolAllocations(EventSystem& eventSystem)
+	{
+		constexpr int EVENTS = 10;
+		constexpr int LISTENERS = 100;
+		constexpr int WARMUP = 100;
+		constexpr int ROUNDS = 10000;
+
+		eventSystem.SetMemoryResource(&pool);
+		auto handler = std::make_shared<MessageHandler>(&pool);
+		auto handlerUpdate = std::make_shared<MessageHandlerUpdate>(&pool);
+		auto split = std::make_shared<MessageHandler>(&pool);
+		handler->SetBatchDelivery(8);
+		eventSystem.RegisterMessageHandler(handler, false);
+		eventSystem.RegisterMessageHandlerUpdate(handlerUpdate, false);
+		eventSystem.RegisterRouteHandler("check.split", split, false);
+
+		std::vector<std::shared_ptr<Event>> events;
+		std::vector<EventID> ids;
+		for (int i = 0; i < EVENTS; ++i)
+		{
+			events.push_back(eventSystem.NewAndRegisterEvent<Event>());
+			ids.push_back(events.back()->ID);
+		}
+		// 事件1路由至另一管线，订阅事件0与1的监听器收到的批量消息按管线拆分
+		eventSystem.RouteEvent(*events[1], "check.split");
+		std::vector<std::shared_ptr<CountListener>> listeners;
+		for (int i = 0; i < LISTENERS; ++i)
+		{
+			listeners.push_back(std::make_shared<CountListener>());
+			eventSystem.AddEventHandler(*events[i % EVENTS], listeners.back());
+			eventSystem.AddEventHandler(*events[(i + 1) % EVENTS], listeners.back());
+		}
+
+		auto poll = [&]()
+			{
+				handler->Poll();
+				handlerUpdate->Poll();
+				split->Poll();
+			};
+		auto measure = [&](auto&& round)
+			{
+				for (int r = 0; r < WARMUP; ++r)
+					round();
+				auto before = globalAllocations.load(std::memory_order_relaxed);
+				for (int r = 0; r < ROUNDS; ++r)
+					round();
+				return globalAllocations.load(std::memory_order_relaxed) - before;
+			};
+		auto single = measure([&]()
+			{
+				for (auto& event : events)
+					eventSystem.TriggerEvent(*event);
+				eventSystem.TriggerEventUpdate(*events[0], 1.0);
+				poll();
+			});
+		auto sorted = measure([&]()
+			{
+				eventSystem.TriggerEvents(ids);
+				poll();
+			});
+		eventSystem.SetSubscriptionMatrix(true);
+		auto matrixed = measure([&]()
+			{
+				eventSystem.TriggerEvents(ids);
+				poll();
+			});
+		eventSystem.SetSubscriptionMatrix(false);
+
+		// 监听器0订阅事件0与1：单个触发每轮唤醒3次，两种批量触发每轮各唤醒2次
+		unsigned long long expected = (WARMUP + ROUNDS) * 7ull;
+		report("alloc.pool", single == 0 && sorted == 0 && matrixed == 0 && listeners[0]->count == expected,
+			"global allocations in " + std::to_string(ROUNDS) + " rounds: single " + std::to_string(single)
+			+ ", batch " + std::to_string(sorted) + ", batch with matrix " + std::to_string(matrixed)
+			+ ", " + std::to_string(listeners[0]->count) + " wakes");
+
+		for (auto& listener : listeners)
+			eventSystem.RemoveAllEventForListener(listener);
+		eventSystem.RouteEvent(*events[1], "");
+		eventSystem.RegisterMessageHandler(std::make_shared<MessageHandler>(), false);
+		eventSystem.RegisterMessageHandlerUpdate(std::make_shared<MessageHandlerUpdate>(), false);
+		eventSystem.RegisterRouteHandler("check.split", nullptr, false);
+		eventSystem.SetMemoryResource(nullptr);
+	}
+
+	/**
+	 * @brief 订阅位矩阵与排序两种路径的批量触发向每个监听器投递相同的事件子集：
+	 * 子集按触发顺序排列，去除重复事件，不含未注册或无人订阅的事件，未订阅任何事件的监听器不被唤醒
+	 */
+	void checkBatchParity(EventSystem& eventSystem)
+	{
+		constexpr int EVENTS = 12;
+		constexpr int LISTENERS = 40;
+
+		auto handler = std::make_shared<MessageHandler>();
+		eventSystem.RegisterMessageHandler(handler, false);
+
+		std::vector<std::shared_ptr<Event>> events;
+		for (int i = 0; i < EVENTS; ++i)
+			events.push_back(eventSystem.NewAndRegisterEvent<Event>());
+		// 订阅关系由固定种子的线性同余序列生成，事件11无人订阅
+		std::vector<std::shared_ptr<BatchRecordListener>> listeners;
+		std::vector<std::vector<bool>> subscribed(LISTENERS, std::vector<bool>(EVENTS, false));
+		uint32_t seed = 12345;
+		for (int i = 0; i < LISTENERS; ++i)
+		{
+			listeners.push_back(std::make_shared<BatchRecordListener>());
+			for (int e = 0; e < EVENTS - 1; ++e)
+			{
+				seed = seed * 1103515245u + 12345u;
+				if ((seed >> 16) % 3 == 0)
+				{
+					eventSystem.AddEventHandler(*events[e], listeners.back());
+					subscribed[i][e] = true;
+				}
+			}
+		}
+		// 乱序、重复，并夹带无人订阅与未注册的事件
+		std::vector<EventID> ids;
+		for (int e : { 7, 2, 11, 9, 2, 0, 5, 7, 10, 1, 3, 8, 4, 6 })
+			ids.push_back(events[e]->ID);
+		ids.push_back(~0ull);
+
+		auto run = [&](bool matrix)
+			{
+				eventSystem.SetSubscriptionMatrix(matrix);
+				for (auto& listener : listeners)
+					listener->batches.clear();
+				eventSystem.TriggerEvents(ids);
+				handler->Poll();
+				std::vector<std::vector<std::vector<EventID>>> result;
+				for (auto& listener : listeners)
+					result.push_back(listener->batches);
+				return result;
+			};
+		auto sorted = run(false);
+		auto matrixed = run(true);
+		eventSystem.SetSubscriptionMatrix(false);
+
+		int mismatched = 0;
+		for (int i = 0; i < LISTENERS; ++i)
+		{
+			std::vector<EventID> expected;
+			for (auto id : ids)
+			{
+				for (int e = 0; e < EVENTS; ++e)
+				{
+					if (events[e]->ID == id && subscribed[i][e]
+						&& std::find(expected.begin(), expected.end(), id) == expected.end())
+						expected.push_back(id);
+				}
+			}
+			std::vector<std::vector<EventID>> want;
+			if (expected.empty() == false)
+				want.push_back(expected);
+			if (sorted[i] != want || matrixed[i] != want)
+				++mismatched;
+		}
+		report("batch.parity", mismatched == 0,
+			std::to_string(LISTENERS - mismatched) + "/" + std::to_string(LISTENERS) + " listeners received identical subsets on both paths");
+
+		for (auto& listener : listeners)
+			eventSystem.RemoveAllEventForListener(listener);
+	}
+
+	/**
+	 * @brief 路由至具名管线的事件（含主题路由与静态事件）由管线的处理器分发，未路由或取消路由的事件由默认处理器分发；
+	 * 管线的处理器注销后其积压的消息迁移至默认处理器，再次指定的主题模式替换原有路由
+	 */
+	void checkRouting(EventSystem& eventSystem)
+	{
+		auto handler = std::make_shared<MessageHandler>();
+		auto handlerUpdate = std::make_shared<MessageHandlerUpdate>();
+		auto gameplay = std::make_shared<MessageHandler>();
+		auto cosmetic = std::make_shared<MessageHandler>();
+		auto cosmeticUpdate = std::make_shared<MessageHandlerUpdate>();
+		eventSystem.RegisterMessageHandler(handler, false);
+		eventSystem.RegisterMessageHandlerUpdate(handlerUpdate, false);
+		eventSystem.RegisterRouteHandler("gameplay", gameplay, false);
+		// 主题路由先于管线的处理器与事件指定
+		eventSystem.RouteTopic("check/fx/#", "cosmetic");
+		eventSystem.RegisterRouteHandler("cosmetic", cosmetic, false);
+		eventSystem.RegisterRouteHandlerUpdate("cosmetic", cosmeticUpdate, false);
+
+		auto hit = eventSystem.NewAndRegisterEvent<Event>();
+		auto spark = eventSystem.NewAndRegisterEvent<Event>("check/fx/spark");
+		auto idle = eventSystem.NewAndRegisterEvent<Event>();
+		auto listener = std::make_shared<CountListener>();
+		eventSystem.AddEventHandler(*hit, listener);
+		eventSystem.AddEventHandler(*spark, listener);
+		eventSystem.AddEventHandler(*idle, listener);
+		eventSystem.AddEventHandler(CheckStaticEvent, listener);
+		eventSystem.RouteEvent(*hit, "gameplay");
+		eventSystem.RouteEvent(CheckStaticEvent, "gameplay");
+
+		eventSystem.TriggerEvent(*hit);
+		eventSystem.TriggerEvent(CheckStaticEvent);
+		eventSystem.TriggerEvent(*spark);
+		eventSystem.TriggerEventUpdate(*spark, 1.0);
+		eventSystem.TriggerEvent(*idle);
+		size_t gameplayCount = gameplay->Poll();
+		size_t cosmeticCount = cosmetic->Poll() + cosmeticUpdate->Poll();
+		size_t defaultCount = handler->Poll() + handlerUpdate->Poll();
+		bool routed = gameplayCount == 2 && cosmeticCount == 2 && defaultCount == 1
+			&& eventSystem.GetEventRoute(CheckStaticEvent.ID) == "gameplay" && eventSystem.GetEventRoute(spark->ID) == "cosmetic";
+
+		eventSystem.RouteEvent(*hit, "");
+		eventSystem.RouteEvent(CheckStaticEvent, "");
+		eventSystem.TriggerEvent(*hit);
+		eventSystem.TriggerEvent(CheckStaticEvent);
+		size_t restoredGameplay = gameplay->Poll();
+		size_t restoredDefault = handler->Poll();
+		bool restored = restoredGameplay == 0 && restoredDefault == 2 && eventSystem.GetEventRoute(CheckStaticEvent.ID).empty();
+
+		// 注销管线的处理器：积压的消息与此后的触发均由默认处理器分发
+		eventSystem.RouteEvent(*hit, "gameplay");
+		eventSystem.TriggerEvent(*hit);
+		eventSystem.RegisterRouteHandler("gameplay", nullptr, false);
+		eventSystem.TriggerEvent(*hit);
+		size_t migrated = handler->Poll();
+		bool unregistered = migrated == 2 && gameplay->GetBacklog() == 0 && eventSystem.GetRouteHandler("gameplay") == nullptr;
+
+		// 再次指定同一主题模式
+		size_t rerouted = eventSystem.RouteTopic("check/fx/#", "gameplay");
+		auto flash = eventSystem.NewAndRegisterEvent<Event>("check/fx/flash");
+		bool replaced = rerouted == 1 && eventSystem.GetEventRoute(spark->ID) == "gameplay" && eventSystem.GetEventRoute(flash->ID) == "gameplay";
+		eventSystem.RouteTopic("check/fx/#", "");
+		eventSystem.RouteEvent(*hit, "");
+
+		report("route.pipelines", routed && restored && unregistered && replaced && listener->count == 9,
+			"gameplay " + std::to_string(gameplayCount) + ", cosmetic " + std::to_string(cosmeticCount)
+			+ ", default " + std::to_string(defaultCount) + ", after reset gameplay " + std::to_string(restoredGameplay)
+			+ " default " + std::to_string(restoredDefault) + ", migrated after unregister " + std::to_string(migrated)
+			+ ", topic pattern rerouted " + std::to_string(rerouted));
+
+		eventSystem.RemoveAllEventForListener(listener);
+	}
+
+	/**
+	 * @brief 两个处理线程并发处理时，追踪触发的句柄在所有监听器处理完毕后才完成，后续回调同样在此之后执行
+	 */
+	void checkTrackedCompletion(EventSystem& eventSystem)
+	{
+		constexpr int LISTENERS = 16;
+		constexpr int ROUNDS = 20;
+
+		auto handler = std::make_shared<MessageHandler>();
+		HandlerLaunchConfig config;
+		config.workers = 2;
+		handler->SetLaunchConfig(config);
+		eventSystem.RegisterMessageHandler(handler);
+
+		auto event = eventSystem.NewAndRegisterEvent<Event>();
+		std::atomic<int> ran{ 0 };
+		std::vector<std::shared_ptr<SlowListener>> listeners;
+		for (int i = 0; i < LISTENERS; ++i)
+		{
+			listeners.push_back(std::make_shared<SlowListener>(ran));
+			eventSystem.AddEventHandler(*event, listeners.back());
+		}
+
+		int early = 0;
+		std::atomic<int> earlyCallbacks{ 0 };
+		for (int r = 0; r < ROUNDS; ++r)
+		{
+			int expected = (r + 1) * LISTENERS;
+			auto handle = eventSystem.TriggerEventTracked(*event);
+			handle.then([&ran, &earlyCallbacks, expected]()
+				{
+					// 回调可能晚于 wait 返回执行，此时下一轮的监听器已开始处理
+					if (ran.load(std::memory_order_acquire) < expected)
+						earlyCallbacks.fetch_add(1, std::memory_order_relaxed);
+				});
+			handle.wait();
+			if (handle.is_done() == false || ran.load(std::memory_order_acquire) != expected)
+				++early;
+		}
+		handler->WaitIdle();
+		report("sync.tracked", early == 0 && earlyCallbacks.load() == 0 && ran.load() == ROUNDS * LISTENERS,
+			std::to_string(ROUNDS) + " tracked triggers of " + std::to_string(LISTENERS) + " listeners on 2 workers, "
+			+ std::to_string(early) + " waits and " + std::to_string(earlyCallbacks.load()) + " callbacks completed early");
+
+		for (auto& listener : listeners)
+			eventSystem.RemoveAllEventForListener(listener);
+		eventSystem.RegisterMessageHandler(std::make_shared<MessageHandler>(), false);
+	}
+
+	/**
+	 * @brief 多个生产者并发触发时，WaitIdle 返回时其调用前发送的消息均已处理，生产结束后处理数与发送数相等
+	 */
+	void checkWaitIdle(EventSystem& eventSystem)
+	{
+		constexpr int PRODUCERS = 4;
+		constexpr int TRIGGERS = 5000;
+
+		auto handler = std::make_shared<MessageHandler>();
+		eventSystem.RegisterMessageHandler(handler);
+
+		// 每个生产者触发各自的事件，由各自的监听器计数
+		std::vector<std::shared_ptr<Event>> events;
+		std::vector<std::shared_ptr<AtomicCountListener>> listeners;
+		for (int p = 0; p < PRODUCERS; ++p)
+		{
+			events.push_back(eventSystem.NewAndRegisterEvent<Event>());
+			listeners.push_back(std::make_shared<AtomicCountListener>());
+			eventSystem.AddEventHandler(*events.back(), listeners.back());
+		}
+		std::atomic<int> incomplete{ 0 };
+		std::vector<std::thread> producers;
+		for (int p = 0; p < PRODUCERS; ++p)
+		{
+			producers.emplace_back([&, p]()
+				{
+					for (int i = 1; i <= TRIGGERS; ++i)
+					{
+						eventSystem.TriggerEvent(*events[p]);
+						// 其他生产者仍在发送时，本生产者已发送的消息在 WaitIdle 返回前处理完毕
+						if (i % 1000 == 0)
+						{
+							handler->WaitIdle();
+							if (listeners[p]->count.load(std::memory_order_relaxed) < (unsigned long long)i)
+								incomplete.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+				});
+		}
+		for (auto& producer : producers)
+			producer.join();
+		handler->WaitIdle();
+
+		unsigned long long processed = 0;
+		for (auto& listener : listeners)
+			processed += listener->count.load(std::memory_order_relaxed);
+		unsigned long long posted = (unsigned long long)PRODUCERS * TRIGGERS;
+		report("sync.waitidle", incomplete.load() == 0 && processed == posted && handler->GetBacklog() == 0,
+			"posted " + std::to_string(posted) + ", processed " + std::to_string(processed) + ", "
+			+ std::to_string(incomplete.load()) + " WaitIdle calls returned before the caller's messages were processed");
+
+		for (auto& listener : listeners)
+			eventSystem.RemoveAllEventForListener(listener);
+		eventSystem.RegisterMessageHandler(std::make_shared<MessageHandler>(), false);
+	}
+
+	/**
+	 * @brief 更换消息处理器时，旧处理器积压的消息按原顺序迁移，且排在新处理器此后收到的消息之前
+	 */
+	void checkMigrateOrder(EventSystem& eventSystem)
+	{
+		constexpr int EVENTS = 7;
+		constexpr int BEFORE = 1000;
+		constexpr int AFTER = 200;
+
+		auto oldHandler = std::make_shared<MessageHandler>();
+		auto newHandler = std::make_shared<MessageHandler>();
+		eventSystem.RegisterMessageHandler(oldHandler, false);
+
+		std::vector<std::shared_ptr<Event>> events;
+		for (int i = 0; i < EVENTS; ++i)
+			events.push_back(eventSystem.NewAndRegisterEvent<Event>());
+		auto listener = std::make_shared<BatchRecordListener>();
+		for (auto& event : events)
+			eventSystem.AddEventHandler(*event, listener);
+
+		std::vector<EventID> expected;
+		for (int i = 0; i < BEFORE + AFTER; ++i)
+		{
+			// 迁移发生在第BEFORE次触发之前，此后的触发发送至新处理器
+			if (i == BEFORE)
+				eventSystem.RegisterMessageHandler(newHandler, false);
+			eventSystem.TriggerEvent(*events[(i * 3) % EVENTS]);
+			expected.push_back(events[(i * 3) % EVENTS]->ID);
+		}
+		size_t leftover = oldHandler->Poll();
+		newHandler->Poll();
+		std::vector<EventID> received;
+		for (auto& batch : listener->batches)
+			received.insert(received.end(), batch.begin(), batch.end());
+		size_t firstMismatch = std::mismatch(expected.begin(), expected.end(), received.begin(), received.end()).first - expected.begin();
+		report("sync.migrate", received == expected && leftover == 0,
+			std::to_string(received.size()) + "/" + std::to_string(expected.size()) + " messages received, in order up to "
+			+ std::to_string(firstMismatch) + ", " + std::to_string(leftover) + " left in the old handler");
+
+		eventSystem.RemoveAllEventForListener(listener);
+		eventSystem.RegisterMessageHandler(std::make_shared<MessageHandler>(), false);
+	}
+
+	/**
+	 * @brief 虚拟时间下固定步长时钟的更新次数、插值系数与唤起的事件数量：
+	 * 逐帧推进时每帧更新一次，跨越多帧时一次补足，超出补帧上限的更新被丢弃
+	 */
+	void checkVirtualTime(EventSystem& eventSystem)
+	{
+		constexpr double FPS = 100;		// 更新周期10毫秒，虚拟计数下可整除
+		constexpr int MAX_CATCH_UP = 5;
+
+		Clock& clock = Clock::Instance();
+		auto handlerUpdate = std::make_shared<MessageHandlerUpdate>();
+		eventSystem.RegisterMessageHandlerUpdate(handlerUpdate, false);
+		auto event = eventSystem.NewAndRegisterEvent<Event>();
+		auto listener = std::make_shared<CountListener>();
+		eventSystem.AddEventHandler(*event, listener);
+
+		clock.SetVirtualTime(true);
+		ClockID id = clock.NewClock(FPS);
+		clock.SetFixedStep(id, true, MAX_CATCH_UP);
+		clock.SetClockStats(id, true);
+		clock.AddEvent(id, *event);
+
+		struct Step
+		{
+			const char* name;	// 阶段名称
+			ull updates;		// 本时钟的更新次数
+			int count;			// 最后一次更新的 GetUpdateCount
+			double alpha;		// 最后一次更新后的插值系数
+			size_t fired;		// 唤起的事件数量
+			ull dropped;		// 丢弃的更新次数
+		};
+		// RunVirtualTime 的返回值包含其他时钟的更新，本时钟的更新次数取自统计
+		ull ticks = 0;
+		auto measure = [&](const char* name)
+			{
+				ClockStatsSnapshot stats = clock.GetClockStats(id);
+				Step step{ name, stats.ticks - ticks, clock.GetUpdateCount(id), clock.GetInterpolationAlpha(id), handlerUpdate->Poll(), stats.dropped };
+				ticks = stats.ticks;
+				return step;
+			};
+		std::vector<Step> actual;
+		// 逐帧推进1秒：100次更新，每次补足1帧
+		clock.RunVirtualTime(1000);
+		actual.push_back(measure("run 1000ms"));
+		// 跨越3.5帧后更新一次：补足3帧，剩余半帧
+		clock.AdvanceVirtualTime(35);
+		clock.GetUpdate(id);
+		actual.push_back(measure("advance 35ms"));
+		// 累积9.2帧：补足5帧，丢弃4帧
+		clock.AdvanceVirtualTime(87);
+		clock.GetUpdate(id);
+		actual.push_back(measure("advance 87ms"));
+		// 不足一帧：不更新，插值系数继续增长
+		clock.AdvanceVirtualTime(5);
+		clock.GetUpdate(id);
+		actual.push_back(measure("advance 5ms"));
+
+		const Step expected[] = {
+			{ "run 1000ms", 100, 1, 0.0, 100, 0 },
+			{ "advance 35ms", 1, 3, 0.5, 3, 0 },
+			{ "advance 87ms", 1, MAX_CATCH_UP, 0.2, MAX_CATCH_UP, 4 },
+			{ "advance 5ms", 0, 0, 0.7, 0, 4 },
+		};
+		bool passed = listener->count == 108;
+		std::string detail;
+		for (size_t n = 0; n < actual.size(); ++n)
+		{
+			const Step& a = actual[n];
+			const Step& e = expected[n];
+			bool ok = a.updates == e.updates && a.count == e.count && std::abs(a.alpha - e.alpha) < 1e-9
+				&& a.fired == e.fired && a.dropped == e.dropped;
+			passed = passed && ok;
+			if (n != 0)
+				detail += "; ";
+			detail += std::string(a.name) + (ok ? "" : " (unexpected)") + ": updates " + std::to_string(a.updates)
+				+ ", count " + std::to_string(a.count) + ", alpha " + std::to_string(a.alpha)
+				+ ", fired " + std::to_string(a.fired) + ", dropped " + std::to_string(a.dropped);
+		}
+		report("clock.virtual", passed, detail);
+
+		clock.EraseClock(id);
+		clock.SetVirtualTime(false);
+		eventSystem.RemoveAllEventForListener(listener);
+		eventSystem.RegisterMessageHandlerUpdate(std::make_shared<MessageHandlerUpdate>(), false);
+	}
+}
+
+auto main(int argc, char** argv) -> int
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+	}
+
+	EventSystem& eventSystem = EventSystem::Instance();
+	if (enabled("alloc"))
+		checkPoolAllocations(eventSystem);
+	if (enabled("batch"))
+		checkBatchParity(eventSystem);
+	if (enabled("route"))
+		checkRouting(eventSystem);
+	if (enabled("sync.tracked"))
+		checkTrackedCompletion(eventSystem);
+	if (enabled("sync.waitidle"))
+		checkWaitIdle(eventSystem);
+	if (enabled("sync.migrate"))
+		checkMigrateOrder(eventSystem);
+	if (enabled("clock"))
+		checkVirtualTime(eventSystem);
+
+	return failures == 0 ? 0 : 1;
+}
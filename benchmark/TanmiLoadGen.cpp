@@ -0,0 +1,413 @@
+/*****************************************************************//**
+ * \file   TanmiLoadGen.cpp
+ * \brief  整体负载生成器，用于浸泡测试与容量规划
+ *
+ * 用法：TanmiLoadGen [--config 配置文件] [--键=值 ...] [--out 文件路径]
+ *
+ * 配置文件每行一个 键=值，# 开头为注释，命令行参数覆盖配置文件；
+ * 可用的键见 LoadConfig，结果以JSON输出
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TanmiEventSystem.hpp"
+#include "TanmiClock.hpp"
+
+using namespace TanmiEngine;
+using LoadClock = std::chrono::steady_clock;
+
+namespace
+{
+	/**
+	 * @brief 负载配置
+	 */
+	struct LoadConfig
+	{
+		int events = 1000;					///< 事件类型数量
+		int listeners = 10000;				///< 监听器数量
+		int subscriptions = 4;				///< 每个监听器订阅的事件数量
+		std::string distribution = "zipf";	///< 订阅分布，uniform 或 zipf
+		double zipf_s = 1.0;				///< Zipf分布指数
+		std::string trigger_distribution = "uniform";	///< 生产者选择事件的分布，uniform 或 zipf
+		int producers = 4;					///< 生产者线程数量
+		double rate = 10000;				///< 每个生产者每秒触发次数，0表示不限速
+		double work_ns = 200;				///< 监听器每次响应的忙等耗时（纳秒）
+		int clocks = 4;						///< 时钟数量
+		double clock_fps = 60;				///< 时钟刷新率
+		int clock_events = 8;				///< 每个时钟绑定的事件数量
+		double duration = 10;				///< 运行时长（秒）
+		unsigned long long seed = 42;		///< 随机数种子
+
+		/**
+		 * @brief 设置一项配置，值无法解析时输出错误并保留原值，此后 Validate 失败
+		 *
+		 * @return true 键有效
+		 * @return false 键无效
+		 */
+		bool Set(const std::string& key, const std::string& value)
+		{
+			try
+			{
+				return set(key, value);
+			}
+			catch (std::logic_error&)
+			{
+				// std::stoi 等在格式错误与越界时分别抛出 invalid_argument 与 out_of_range
+				std::cerr << "invalid value for config key " << key << ": " << value << std::endl;
+				malformed = true;
+			}
+			return true;
+		}
+		/**
+		 * @brief 检查各项配置的取值范围，逐项输出越界的配置
+		 *
+		 * @return true 所有配置有效且均已成功解析
+		 * @return false 存在无效配置
+		 */
+		bool Validate() const
+		{
+			bool valid = malformed == false;
+			auto require = [&](bool ok, const char* message)
+				{
+					if (ok == false)
+					{
+						std::cerr << "invalid config: " << message << std::endl;
+						valid = false;
+					}
+				};
+			// 取反比较使 NaN 同样视为越界
+			require(events > 0, "events must be positive");
+			require(listeners >= 0, "listeners must not be negative");
+			require(subscriptions >= 0, "subscriptions must not be negative");
+			require(distribution == "uniform" || distribution == "zipf", "distribution must be uniform or zipf");
+			require(trigger_distribution == "uniform" || trigger_distribution == "zipf", "trigger_distribution must be uniform or zipf");
+			require(zipf_s >= 0 && std::isfinite(zipf_s), "zipf_s must be a finite non-negative number");
+			require(producers >= 0, "producers must not be negative");
+			require(rate >= 0 && std::isfinite(rate), "rate must be a finite non-negative number");
+			require(work_ns >= 0 && std::isfinite(work_ns), "work_ns must be a finite non-negative number");
+			require(clocks >= 0, "clocks must not be negative");
+			require(clocks == 0 || (clock_fps > 0 && std::isfinite(clock_fps)), "clock_fps must be positive");
+			require(clock_events >= 0, "clock_events must not be negative");
+			require(duration >= 0 && std::isfinite(duration), "duration must be a finite non-negative number");
+			return valid;
+		}
+		/**
+		 * @brief 以JSON格式输出
+		 */
+		std::string ToJson() const
+		{
+			std::ostringstream ss;
+			ss << "{\"events\":" << events << ",\"listeners\":" << listeners << ",\"subscriptions\":" << subscriptions
+				<< ",\"distribution\":\"" << distribution << "\",\"zipf_s\":" << zipf_s
+				<< ",\"trigger_distribution\":\"" << trigger_distribution << "\",\"producers\":" << producers
+				<< ",\"rate\":" << rate << ",\"work_ns\":" << work_ns << ",\"clocks\":" << clocks
+				<< ",\"clock_fps\":" << clock_fps << ",\"clock_events\":" << clock_events
+				<< ",\"duration\":" << duration << ",\"seed\":" << seed << "}";
+			return ss.str();
+		}
+	private:
+		bool set(const std::string& key, const std::string& value)
+		{
+			if (key == "events") events = std::stoi(value);
+			else if (key == "listeners") listeners = std::stoi(value);
+			else if (key == "subscriptions") subscriptions = std::stoi(value);
+			else if (key == "distribution") distribution = value;
+			else if (key == "zipf_s") zipf_s = std::stod(value);
+			else if (key == "trigger_distribution") trigger_distribution = value;
+			else if (key == "producers") producers = std::stoi(value);
+			else if (key == "rate") rate = std::stod(value);
+			else if (key == "work_ns") work_ns = std::stod(value);
+			else if (key == "clocks") clocks = std::stoi(value);
+			else if (key == "clock_fps") clock_fps = std::stod(value);
+			else if (key == "clock_events") clock_events = std::stoi(value);
+			else if (key == "duration") duration = std::stod(value);
+			else if (key == "seed") seed = std::stoull(value);
+			else return false;
+			return true;
+		}
+		bool malformed = false;	//< 存在无法解析的值
+	};
+
+	/**
+	 * @brief 事件选择器，按均匀分布或Zipf分布返回事件下标
+	 */
+	class EventPicker
+	{
+	public:
+		EventPicker(int count, const std::string& distribution, double s)
+		{
+			cdf.resize(count);
+			double sum = 0;
+			for (int i = 0; i < count; ++i)
+			{
+				sum += distribution == "zipf" ? 1.0 / std::pow(i + 1, s) : 1.0;
+				cdf[i] = sum;
+			}
+			for (auto& c : cdf)
+				c /= sum;
+		}
+		int operator()(std::mt19937_64& rng) const
+		{
+			double u = std::uniform_real_distribution<double>(0, 1)(rng);
+			auto it = std::lower_bound(cdf.begin(), cdf.end(), u);
+			return it == cdf.end() ? (int)cdf.size() - 1 : (int)(it - cdf.begin());
+		}
+	private:
+		std::vector<double> cdf;	//< 累积分布
+	};
+
+	ShardedCounter wakes;	//< 监听器响应次数
+
+	/**
+	 * @brief 忙等指定时长，模拟监听器的处理开销
+	 */
+	void spinFor(double ns)
+	{
+		if (ns <= 0)
+			return;
+		auto end = LoadClock::now() + std::chrono::nanoseconds((long long)ns);
+		while (LoadClock::now() < end);
+	}
+
+	/**
+	 * @brief 负载监听器
+	 */
+	class LoadListener : public Listener
+	{
+	public:
+		explicit LoadListener(double _work_ns) :work_ns(_work_ns)
+		{}
+		virtual void WakeEvent(const EventID event)
+		{
+			spinFor(work_ns);
+			wakes.Add();
+		}
+		virtual void WakeEventUpdate(const EventID event, double ms)
+		{
+			spinFor(work_ns);
+			wakes.Add();
+		}
+	private:
+		double work_ns;	//< 每次响应的耗时
+	};
+
+	/**
+	 * @brief 丢弃所有输出的流缓冲区，用于屏蔽无监听器事件的异常输出
+	 */
+	class NullBuffer : public std::streambuf
+	{
+	protected:
+		virtual int overflow(int c)
+		{
+			return c;
+		}
+	};
+
+	/**
+	 * @brief 读取 /proc/self/status 中的内存项（KB），不可用时返回0
+	 */
+	unsigned long long readStatusKb(const char* key)
+	{
+		std::ifstream file("/proc/self/status");
+		std::string line;
+		size_t len = std::strlen(key);
+		while (std::getline(file, line))
+		{
+			if (line.compare(0, len, key) == 0 && line.size() > len && line[len] == ':')
+				return std::stoull(line.substr(len + 1));
+		}
+		return 0;
+	}
+}
+
+auto main(int argc, char** argv) -> int
+{
+	LoadConfig config;
+	std::string out;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--out" && i + 1 < argc)
+		{
+			out = argv[++i];
+		}
+		else if (arg == "--config" && i + 1 < argc)
+		{
+			std::ifstream file(argv[++i]);
+			if (file.is_open() == false)
+			{
+				std::cerr << "cannot open config file: " << argv[i] << std::endl;
+				return 1;
+			}
+			std::string line;
+			while (std::getline(file, line))
+			{
+				auto pos = line.find('=');
+				if (line.empty() || line[0] == '#' || pos == std::string::npos)
+					continue;
+				if (config.Set(line.substr(0, pos), line.substr(pos + 1)) == false)
+					std::cerr << "unknown config key: " << line.substr(0, pos) << std::endl;
+			}
+		}
+		else if (arg.compare(0, 2, "--") == 0 && arg.find('=') != std::string::npos)
+		{
+			auto pos = arg.find('=');
+			if (config.Set(arg.substr(2, pos - 2), arg.substr(pos + 1)) == false)
+				std::cerr << "unknown config key: " << arg.substr(2, pos - 2) << std::endl;
+		}
+		else
+		{
+			std::cerr << "unknown argument: " << arg << std::endl;
+			return 1;
+		}
+	}
+	if (config.Validate() == false)
+		return 1;
+
+	EventSystem& eventSystem = EventSystem::Instance();
+	Clock& clock = Clock::Instance();
+	eventSystem.RegisterMessageHandler(std::make_shared<MessageHandler>());
+	eventSystem.RegisterMessageHandlerUpdate(std::make_shared<MessageHandlerUpdate>());
+
+	// 构建拓扑
+	std::mt19937_64 rng(config.seed);
+	std::vector<std::shared_ptr<Event>> events;
+	for (int i = 0; i < config.events; ++i)
+		events.push_back(eventSystem.NewAndRegisterEvent<Event>());
+	EventPicker subscribePicker(config.events, config.distribution, config.zipf_s);
+	std::vector<std::shared_ptr<LoadListener>> listeners;
+	std::vector<bool> subscribed(config.events, false);
+	for (int i = 0; i < config.listeners; ++i)
+	{
+		listeners.push_back(std::make_shared<LoadListener>(config.work_ns));
+		for (int s = 0; s < config.subscriptions; ++s)
+		{
+			int e = subscribePicker(rng);
+			eventSystem.AddEventHandler(*events[e], listeners.back());
+			subscribed[e] = true;
+		}
+	}
+	// 时钟仅绑定有订阅者的事件，Clock::AddEvent 拒绝无人订阅的事件
+	std::vector<int> clockable;
+	for (int e = 0; e < config.events; ++e)
+	{
+		if (subscribed[e])
+			clockable.push_back(e);
+	}
+	if (config.clocks > 0 && config.clock_events > 0 && clockable.empty())
+		std::cerr << "no subscribed events, clocks run without events" << std::endl;
+	std::vector<ClockID> clocks;
+	for (int c = 0; c < config.clocks; ++c)
+	{
+		clocks.push_back(clock.NewClock(config.clock_fps));
+		for (int e = 0; e < config.clock_events && clockable.empty() == false; ++e)
+			clock.AddEvent(clocks.back(), *events[clockable[(c * config.clock_events + e) % clockable.size()]]);
+	}
+	unsigned long long rss_setup = readStatusKb("VmRSS");
+
+	// 运行
+	NullBuffer null;
+	auto old = std::cout.rdbuf(&null);
+	eventSystem.ResetMetrics();
+	std::atomic<bool> running{ true };
+	std::atomic<unsigned long long> triggers{ 0 };
+	std::atomic<unsigned long long> clock_updates{ 0 };
+	std::vector<std::thread> threads;
+	EventPicker triggerPicker(config.events, config.trigger_distribution, config.zipf_s);
+	auto begin = LoadClock::now();
+	for (int p = 0; p < config.producers; ++p)
+	{
+		threads.emplace_back([&, p]()
+			{
+				std::mt19937_64 local(config.seed + p + 1);
+				auto interval = config.rate > 0 ? std::chrono::nanoseconds((long long)(1e9 / config.rate)) : std::chrono::nanoseconds(0);
+				auto next = LoadClock::now();
+				unsigned long long count = 0;
+				while (running.load(std::memory_order_relaxed))
+				{
+					if (config.rate > 0)
+					{
+						next += interval;
+						auto now = LoadClock::now();
+						if (next > now)
+							std::this_thread::sleep_until(next);
+						else if (now - next > std::chrono::milliseconds(100))
+							next = now;		// 落后过多时不再追赶，避免恢复后的突发
+					}
+					eventSystem.TriggerEvent(*events[triggerPicker(local)]);
+					++count;
+				}
+				triggers.fetch_add(count, std::memory_order_relaxed);
+			});
+	}
+	if (config.clocks > 0)
+	{
+		threads.emplace_back([&]()
+			{
+				unsigned long long count = 0;
+				while (running.load(std::memory_order_relaxed))
+				{
+					for (auto id : clocks)
+						count += clock.GetUpdate(id);
+					std::this_thread::sleep_for(std::chrono::microseconds(200));
+				}
+				clock_updates.fetch_add(count, std::memory_order_relaxed);
+			});
+	}
+	std::this_thread::sleep_for(std::chrono::duration<double>(config.duration));
+	running.store(false);
+	for (auto& t : threads)
+		t.join();
+	auto produced = LoadClock::now();
+	unsigned long long wakes_at_stop = wakes.Value();
+	// 等待积压的消息处理完毕，计入排空耗时
+	eventSystem.GetMessageHandler()->WaitIdle();
+	eventSystem.GetMessageHandlerUpdate()->WaitIdle();
+	auto drained = LoadClock::now();
+	std::cout.rdbuf(old);
+
+	// 报告
+	double seconds = std::chrono::duration<double>(produced - begin).count();
+	double drain_ms = std::chrono::duration<double, std::milli>(drained - produced).count();
+	auto metrics = eventSystem.GetMetrics();
+	std::ostringstream ss;
+	ss << "{\"config\":" << config.ToJson()
+		<< ",\"elapsed_s\":" << seconds
+		<< ",\"drain_ms\":" << drain_ms
+		<< ",\"triggers\":" << triggers.load()
+		<< ",\"triggers_per_sec\":" << triggers.load() / seconds
+		<< ",\"clock_updates\":" << clock_updates.load()
+		<< ",\"wakes\":" << wakes.Value()
+		<< ",\"wakes_per_sec\":" << wakes_at_stop / seconds
+		<< ",\"not_found\":" << metrics.not_found
+		<< ",\"handler\":" << metrics.handler.ToJson()
+		<< ",\"handler_update\":" << metrics.handler_update.ToJson()
+		<< ",\"memory_kb\":{\"rss_setup\":" << rss_setup
+		<< ",\"rss_end\":" << readStatusKb("VmRSS")
+		<< ",\"rss_peak\":" << readStatusKb("VmHWM") << "}}\n";
+	if (out.empty())
+	{
+		std::cout << ss.str();
+	}
+	else
+	{
+		std::ofstream file(out);
+		file << ss.str();
+		std::cerr << "results written to " << out << std::endl;
+	}
+	return 0;
+}
\ No newline at end of file
@@ -21,13 +21,18 @@ auto main() -> int
 
 	EventSystem& eventSystem = EventSystem::Instance();
 
-	eventSystem.UseMessageHandlerDefault();
+	auto messageHandler = std::make_shared<MessageHandler>();
+	auto messageHandlerUpdate = std::make_shared<MessageHandlerUpdate>();
+	eventSystem.RegisterMessageHandler(messageHandler, false);
+	eventSystem.RegisterMessageHandlerUpdate(messageHandlerUpdate, false);
 	auto gameStart = j->GenStart();
 	eventSystem.TriggerEvent(*gameStart);
 
 	while (j->gameOver != true)
 	{
 		clock.GetUpdate(Global);
+		messageHandler->PumpFor(std::chrono::milliseconds(2));
+		messageHandlerUpdate->PumpFor(std::chrono::milliseconds(2));
 	}
 	return 0;
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
 /*****************************************************************//**
  * \file   TanmiClock.hpp
- * \brief  ¼ϵͳʹõʱϵͳ
+ * \brief  事件系统使用的时钟系统
  * 
  * \author tanmika
  * \email  tanmika@foxmail.com
@@ -9,37 +9,46 @@
 
 #pragma once
 #include <iostream>
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <chrono>
+#endif
 #include <time.h>
 #include <string>
 #include <unordered_map>
+#include <memory_resource>
 #include <mutex>
 #include <algorithm>
 #include <exception>
+#include <atomic>
+#ifdef __linux__
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif // __linux__
 
 #include "TanmiEventSystem.hpp"
+#include "TanmiHistogram.hpp"
+#include "TanmiMemory.hpp"
 
 namespace TanmiEngine
 {
-	using ull = unsigned long long;	///< ʹ unsigned long long  ull
-	using lint = LARGE_INTEGER;		///< ʹ LARGE_INTEGER  lint
-	using ClockID = int;			///< ʹ int  ClockID
-
-#ifdef EVENT_SYSTEM
+	using ull = unsigned long long;	///< 使用 unsigned long long 定义 ull。
+#ifdef _WIN32
+	using lint = LARGE_INTEGER;		///< 使用 LARGE_INTEGER 定义 lint。
+#else
 	/**
-	 * @brief ˳ȡ¼
+	 * @brief 非Windows平台下与 LARGE_INTEGER 布局一致的计数类型
 	 */
-	template<typename Container>
-	concept EventContainer = requires(Container c)
+	union lint
 	{
-		typename Container::value_type;
-			requires std::is_base_of_v<Event, typename Container::value_type>;
-			requires std::ranges::input_range<Container>;
+		long long QuadPart;
 	};
-#endif // EVENT_SYSTEM
+#endif // _WIN32
+	using ClockID = int;			///< 使用 int 定义 ClockID。
 
 	/**
-	 * @brief Clock 쳣ࡣ
+	 * @brief Clock 类异常基类。
 	 */
 	class ClockException : public std::exception
 	{
@@ -50,7 +59,7 @@ namespace TanmiEngine
 		}
 	};
 	/**
-	 * @brief ֵԽ쳣ࡣ
+	 * @brief 数值越界异常类。
 	 */
 	class ClockOutOfRangeException : public ClockException
 	{
@@ -61,7 +70,7 @@ namespace TanmiEngine
 		}
 	};
 	/**
-	 * @brief ʱδҵ쳣ࡣ
+	 * @brief 时钟未找到异常类。
 	 */
 	class ClockNotFoundException : public ClockException
 	{
@@ -71,9 +80,31 @@ namespace TanmiEngine
 			return "::Expection clock_not_found";
 		}
 	};
+	/**
+	 * @brief 未处于虚拟时间模式异常类。
+	 */
+	class ClockNotVirtualException : public ClockException
+	{
+	public:
+		virtual const char* what () const throw ()
+		{
+			return "::Expection not_virtual_time";
+		}
+	};
+	/**
+	 * @brief 父时钟无效异常类（形成环路等）。
+	 */
+	class ClockInvalidParentException : public ClockException
+	{
+	public:
+		virtual const char* what () const throw ()
+		{
+			return "::Expection invalid_parent";
+		}
+	};
 #ifdef EVENT_SYSTEM
 	/**
-	 * @brief ʱ¼δҵ쳣ࡣ
+	 * @brief 时钟事件未找到异常类。
 	 */
 	class ClockEventNotFoundException :public ClockException
 	{
@@ -86,56 +117,138 @@ namespace TanmiEngine
 #endif // EVENT_SYSTEM
 
 	/**
-	 * @brief ڱʾʱԪأһЩʱصԺͷ
+	 * @brief 时钟运行统计，所有时长均以纳秒为单位
+	 *
+	 * 由更新线程写入，可在任意线程无锁读取
+	 */
+	struct ClockStats
+	{
+		Histogram lateness;			///< 更新时刻相对更新点的延迟
+		Histogram interval;			///< 相邻两次更新的间隔
+		Histogram dispatch;			///< 唤起时钟事件的耗时
+		std::atomic<ull> ticks{ 0 };	///< 更新次数
+		std::atomic<ull> dropped{ 0 };	///< 因轮询不及时而丢失的更新次数
+		ull last_fire = 0;			///< 上次更新的计数点
+	};
+
+	/**
+	 * @brief 时钟运行统计快照
+	 */
+	struct ClockStatsSnapshot
+	{
+		ClockID id = 0;				///< 时钟ID
+		ull ticks = 0;				///< 更新次数
+		ull dropped = 0;			///< 丢失的更新次数
+		HistogramSnapshot lateness;	///< 更新延迟（纳秒）
+		HistogramSnapshot interval;	///< 更新间隔（纳秒）
+		HistogramSnapshot dispatch;	///< 事件唤起耗时（纳秒）
+
+		/**
+		 * @brief 以JSON格式输出
+		 *
+		 * @return std::string JSON字符串
+		 */
+		std::string ToJson() const
+		{
+			return "{\"clock\":" + std::to_string(id)
+				+ ",\"ticks\":" + std::to_string(ticks)
+				+ ",\"dropped\":" + std::to_string(dropped)
+				+ ",\"lateness_ns\":" + lateness.ToJson()
+				+ ",\"interval_ns\":" + interval.ToJson()
+				+ ",\"dispatch_ns\":" + dispatch.ToJson() + "}";
+		}
+	};
+
+	/**
+	 * @brief 该类用于表示时钟元素，包含一些时钟相关的属性和方法。
 	 *
-	 * ΪʱԪֱӱ
+	 * 该类作为时钟元，不可直接被调用
 	 */
 	class ClockElem
 	{
 	public:
-		~ClockElem() = default;	///< 
-		ClockElem() = delete;	///< ĬϹ캯
+		/**
+		 * @brief 析构函数，关闭timerfd
+		 */
+		~ClockElem()
+		{
+#ifdef __linux__
+			if (timer_fd.load() >= 0)
+				close(timer_fd.load());
+#endif // __linux__
+		}
+		ClockElem() = delete;	///< 禁用默认构造函数
 
 		 /**
-		 * @brief 캯ڸʱԪ
-		 * @param ref οԪ
-		 * @param _id ʱԪID
-		 * @param _cycle ʱԪصļֵ
+		 * @brief 构造函数，用于复制时钟元素
+		 * @param ref 参考元素
+		 * @param _id 新时钟元素ID
+		 * @param _cycle 新时钟元素的计数值
 		 */
 		ClockElem(ClockElem& ref, ClockID _id, ull _cycle);
 
 		/**
-		* @brief 캯ڴʱԪ
-		* @param[in] _id ʱԪID
-		* @param[in] _cycle 
-		* @param[in] _update 
-		* @param[in] _scale ʱӷ
-		* @param[in] _pause Ƿͣ
+		* @brief 构造函数，用于创建新时钟元素
+		* @param[in] _id 时钟元素ID
+		* @param[in] _cycle 计数周期
+		* @param[in] _update 更新周期
+		* @param[in] _scale 时钟放缩比例
+		* @param[in] _pause 是否暂停
 		*/
 		ClockElem(ClockID _id, ull _cycle, ull _update, float _scale, bool _pause) :
 			id(_id), cycle(_cycle), last_cycle(_cycle), update_tick(_update), ins_cycle(_cycle),
-			pause_cycle(0), relative_tick(0), scale(_scale), pause(_pause), temp_ull(0), temp_lint({})
+			pause_cycle(0), relative_tick(0), scale(_scale), pause(_pause), temp_ull(0), temp_lint({}),
+			fixed_step(false), max_catch_up(0), update_count(0), alpha(0),
+			pause_total(0)
 		{}
 
 		//
-		// cycle -> , tick -> 
+		// cycle -> 绝对周期, tick -> 相对周期
+		//
+		ClockID id;				///< 时钟元素ID
+		ull cycle;              ///< 上次唤起更新计数点
+		ull last_cycle;         ///< 上次有效更新帧计数点
+		ull update_tick;        ///< 更新周期
+		ull ins_cycle;          ///< 初始时计数点
+		ull pause_cycle;        ///< 暂停时刻计数点
+		ull relative_tick;      ///< 相对经过的总计数
+		float scale;            ///< 放缩率
+		bool pause;             ///< 是否暂停
+		ull temp_ull;           ///< 缓冲
+		lint temp_lint;         ///< 缓冲
+		std::mutex lock;        ///< 数据锁
+		std::mutex templock;    ///< 缓冲锁
+
+		//
+		// 固定步长模式下 cycle 为已计入更新的计数点，当前计数与其差值即为累积余量
+		//
+		bool fixed_step;        ///< 是否使用固定步长
+		int max_catch_up;       ///< 单次轮询最多补足的更新次数
+		int update_count;       ///< 上次轮询产生的更新次数
+		double alpha;           ///< 上次轮询后余量占更新周期的比例，用于渲染插值
+
+		//
+		// 子时钟的计数点均以父时钟的运行计数（去除暂停时长）为基准，
+		// 父时钟暂停时子时钟的基准随之停止，无需逐个修改子时钟；
+		// 父时钟在 SetParent 中于子时钟的锁内修改，而其他时钟沿父链读取时不持有该锁，因此以原子方式读写
 		//
-		ClockID id;				///< ʱԪID
-		ull cycle;              ///< ϴλ¼
-		ull last_cycle;         ///< ϴЧ֡
-		ull update_tick;        ///< 
-		ull ins_cycle;          ///< ʼʱ
-		ull pause_cycle;        ///< ͣʱ̼
-		ull relative_tick;      ///< Ծܼ
-		float scale;            ///< 
-		bool pause;             ///< Ƿͣ
-		ull temp_ull;           ///< 
-		lint temp_lint;         ///< 
-		std::mutex lock;        ///< 
-		std::mutex templock;    ///< 
+		std::atomic<std::shared_ptr<ClockElem>> parent;	///< 父时钟
+		ull pause_total;        ///< 累计暂停的计数
+
+		std::shared_ptr<ClockStats> stats;	///< 运行统计，未开启时为空
+		std::atomic<int> timer_fd{ -1 };	///< 更新通知的timerfd，未创建时为-1；创建于数据锁内，读取时不持锁
 
 #ifdef EVENT_SYSTEM
-		std::vector<EventID> eventList;  ///< ¼б
+		std::vector<EventID> eventList;  ///< 事件列表
+
+		//
+		// 自适应模式下 update_tick 随消息积压在 [target_tick, max_tick] 间调节
+		//
+		bool adaptive = false;  ///< 是否根据消息积压自动调节刷新率
+		ull target_tick = 0;    ///< 设定的更新周期
+		ull max_tick = 0;       ///< 允许的最大更新周期（最低刷新率）
+		size_t high_water = 0;  ///< 积压消息数上限
+		double max_age = 0;     ///< 积压消息等待时长上限（毫秒）
 #endif // EVENT_SYSTEM
 	};
 
@@ -148,194 +261,454 @@ namespace TanmiEngine
 		this->pause = e.pause;
 		this->temp_ull = e.temp_ull;
 		this->temp_lint = e.temp_lint;
+		this->fixed_step = e.fixed_step;
+		this->max_catch_up = e.max_catch_up;
+		this->update_count = 0;
+		this->alpha = 0;
+		this->parent.store(e.parent.load());
+		this->pause_total = e.pause_total;
+#ifdef EVENT_SYSTEM
+		this->adaptive = e.adaptive;
+		this->target_tick = e.target_tick;
+		this->max_tick = e.max_tick;
+		this->high_water = e.high_water;
+		this->max_age = e.max_age;
+#endif // EVENT_SYSTEM
 	}
 
 	/**
-	 * @brief ඨһ֡ļʱϵͳ
+	 * @brief 该类定义了一个基于帧计数的计时器系统
 	 *
-	 * ڵģʽʵ
+	 * 基于单例模式实现
 	 */
 	class Clock
 	{
 	private:
 		/**
-		 * @brief һ¼ ClockElem ָĹϣڴ洢ʱԪ
+		 * @brief 一个事件名到 ClockElem 共享指针的哈希表，用于存储计时器元素
 		 */
-		std::unordered_map<ClockID, std::shared_ptr<ClockElem>> clockMap;
-		std::mutex lock_clk;	///< ڱ֤̰߳ȫ
-		ull temp_ull_clk;		///< ڻullʱӼ
-		lint temp_lint_clk;		///< ڻlintʱӼ
+		std::pmr::unordered_map<ClockID, std::shared_ptr<ClockElem>> clockMap;
+		std::mutex lock_clk;	///< 互斥锁，用于保证线程安全
+		ull temp_ull_clk;		///< 类内缓存ull时钟计数
+		lint temp_lint_clk;		///< 类内缓存lint时钟计数
+		std::atomic<bool> virtual_time;		///< 是否使用虚拟时间
+		std::atomic<ull> virtual_cycle;		///< 虚拟时间计数
+		std::atomic<ull> real_offset;		///< 真实时间计数偏移（虚拟时间推进的累计量）
 	private:
-		const int MAX_FRAME_RATE_PER_SECOND = 1000;		///< ֡
-		const double MIN_FRAME_RATE_PER_SECOND = 0.001;	///< С֡
-		const int MAX_SCALE = 1000;			///< ű
-		const double MIN_SCALE = 0.001;		///< Сű
+		const int MAX_FRAME_RATE_PER_SECOND = 1000;		///< 最大帧率
+		const double MIN_FRAME_RATE_PER_SECOND = 0.001;	///< 最小帧率
+		const int MAX_SCALE = 1000;			///< 最大缩放倍数
+		const double MIN_SCALE = 0.001;		///< 最小缩放倍数
 	private:
-		Clock();	///< 캯
-		Clock(Clock&) = delete;	///< ÿ캯
-		Clock& operator=(Clock&) = delete;	///< ÿֵ
-		Clock(Clock&&) = delete;	///< ƶ캯
-		Clock& operator=(Clock&&) = delete;	///< ƶֵ
+		Clock();	///< 构造函数
+		Clock(Clock&) = delete;	///< 禁用拷贝构造函数
+		Clock& operator=(Clock&) = delete;	///< 禁用拷贝赋值运算符
+		Clock(Clock&&) = delete;	///< 禁用移动构造函数
+		Clock& operator=(Clock&&) = delete;	///< 禁用移动赋值运算符
 		//----------tool----------
 		/**
-		* @brief ȡµʱID
-		* @return µʱID
+		* @brief 获取新的时钟ID
+		* @return 新的时钟ID
 		*/
 		ClockID getNewID();
 		/**
-		* @brief ȡʱӶָ룬ʧʱnullptr
-		* @param _id ʱӶID
-		* @return std::shared_ptr<ClockElem> ʱӶָ
-		* @return nullptr δҵĿ
+		* @brief 获取分配时钟元素使用的分配器
+		*/
+		std::pmr::polymorphic_allocator<ClockElem> elemAllocator()
+		{
+			return std::pmr::polymorphic_allocator<ClockElem>(clockMap.get_allocator().resource());
+		}
+		/**
+		* @brief 获取时钟对象指针，失败时返回nullptr
+		* @param _id 时钟对象ID
+		* @return std::shared_ptr<ClockElem> 时钟对象指针
+		* @return nullptr 未找到目标对象
 		*/
 		inline std::shared_ptr<ClockElem> getIterator(const ClockID _id);
 		/**
-		* @brief ȡullʱӼƵʣʹڻ
+		* @brief 读取时钟对象的运行统计
+		* @param e 时钟对象指针
+		* @param snapshot 用于接收统计快照
+		* @return true 已开启统计
+		* @return false 未开启统计
+		*/
+		inline bool snapshotStats(const std::shared_ptr<ClockElem>& e, ClockStatsSnapshot& snapshot);
+		/**
+		* @brief 获取ull时钟计数与频率，使用类内缓冲
 		*
-		* @return std::pair<ull, ull> ullʱӼƵ
+		* @return std::pair<ull, ull> ull时钟计数和频率
 		*/
 		inline std::pair<ull, ull> getCycleAndFreqIns();
 		/**
-		* @brief ȡullʱӼʹԪػ
+		* @brief 获取ull时钟计数，使用元素缓冲
 		*
-		* @param _id ʱӶID
-		* @return ull& ʱӼ
+		* @param _id 时钟对象ID
+		* @return ull& 时钟计数
 		*/
 		inline ull& getCycleNow(const ClockID _ID);
 		/**
-		* @brief ȡullʱӼʹԪػ
+		* @brief 获取ull时钟计数，使用元素缓冲
 		*
-		* @param i ʱӶָ
-		* @return ull& ʱӼ
+		* @param i 时钟对象指针
+		* @return ull& 时钟计数
 		*/
 		inline ull& getCycleNow(std::shared_ptr<ClockElem> i);
 		/**
-		* @brief ȡullʱƵʣʹԪػ
+		* @brief 获取ull时钟频率，使用元素缓冲
 		*
-		* @param _id ʱӶID
-		* @return ull& ʱƵ
+		* @param _id 时钟对象ID
+		* @return ull& 时钟频率
 		*/
 		inline ull& getFreqNow(const ClockID _id);
 		/**
-		* @brief ȡullʱƵʣʹԪػ
+		* @brief 获取ull时钟频率，使用元素缓冲
 		*
-		* @param i ʱӶָ
-		* @return ull& ʱƵ
+		* @param i 时钟对象指针
+		* @return ull& 时钟频率
 		*/
 		inline ull& getFreqNow(std::shared_ptr<ClockElem> i);
+		/**
+		* @brief 读取硬件计数器
+		*
+		* @return ull 硬件计数
+		*/
+		static inline ull queryRealCycle();
+		/**
+		* @brief 读取当前时间源计数，虚拟时间模式下返回虚拟计数
+		*
+		* @return ull 时间源计数
+		*/
+		inline ull queryCycle();
+		/**
+		* @brief 读取时间源频率，虚拟时间与真实时间使用相同频率
+		*
+		* @return ull 时间源频率
+		*/
+		static inline ull queryFreq();
+		/**
+		* @brief 获取时钟元素所在的计数基准，根时钟为时间源计数，子时钟为父时钟的运行计数
+		*
+		* @param i 时钟对象指针
+		* @return ull 基准计数
+		*/
+		inline ull baseCycle(const std::shared_ptr<ClockElem>& i);
+		/**
+		* @brief 获取时钟元素的运行计数，即基准计数去除暂停时长，暂停期间保持不变
+		*
+		* @param i 时钟对象指针
+		* @return ull 运行计数
+		*/
+		inline ull runningCycle(const std::shared_ptr<ClockElem>& i);
+		/**
+		* @brief 获取时钟元素与其所有父时钟缩放率的乘积
+		*
+		* @param i 时钟对象指针
+		* @return double 实际缩放率
+		*/
+		inline double effectiveScale(const std::shared_ptr<ClockElem>& i);
+		/**
+		* @brief 判断时钟元素自身或其任一父时钟是否暂停
+		*
+		* @param i 时钟对象指针
+		* @return true 实际处于暂停
+		* @return false 正在运行
+		*/
+		inline bool effectivePause(const std::shared_ptr<ClockElem>& i);
+		/**
+		* @brief 记录一次更新的统计信息
+		*
+		* @param stats 运行统计
+		* @param now 更新时刻计数
+		* @param due 更新点计数
+		* @param dropped 丢失的更新次数
+		*/
+		inline void recordUpdate(ClockStats& stats, ull now, ull due, ull dropped);
+#ifdef __linux__
+		/**
+		* @brief 将timerfd设定为时钟的下一更新点，自身或父时钟暂停时解除定时
+		*
+		* @param i 时钟对象指针
+		*/
+		inline void armTimer(const std::shared_ptr<ClockElem>& i);
+		/**
+		* @brief 重新设定时钟元素及其所有子孙时钟的timerfd，用于暂停状态变化后
+		*
+		* @param i 时钟对象指针
+		*/
+		inline void armTimerTree(const std::shared_ptr<ClockElem>& i);
+#endif // __linux__
+#ifdef EVENT_SYSTEM
+		/**
+		* @brief 根据时钟事件路由至的消息处理器（带有时间参数）的积压调节更新周期
+		*
+		* 多个管线时以积压最重者为准，积压超过上限时刷新率减半，积压消退后逐步恢复至设定值
+		* @param i 时钟对象指针
+		*/
+		inline void adaptRate(const std::shared_ptr<ClockElem>& i);
+#endif // EVENT_SYSTEM
 		//----------function----------
 		/**
-		 * @brief ȡʱǷ񳬹µ㣬ʱ
-		 * @param _id ʱID
-		 * @return ǷҪʱ
+		 * @brief 获取时钟是否超过更新点，是则更新时钟
+		 * @param _id 时钟ID
+		 * @return 是否需要更新时钟
 		 */
 		inline bool isUpdate(const ClockID _id);
 		/**
-		 * @brief ȡʱǷ񳬹µ㣬ʱ
-		 * @param i ʱԪָ
-		 * @return ǷҪʱ
+		 * @brief 获取时钟是否超过更新点，是则更新时钟
+		 * @param i 时钟元素指针
+		 * @return 是否需要更新时钟
 		 */
 		inline bool isUpdate(std::shared_ptr<ClockElem> i);
 
 	public:
 		/**
-		 * @brief ȡClockʵ
-		 * @return Clock& Clockʵ
+		 * @brief 获取Clock实例引用
+		 * @return Clock& Clock实例引用
 		 */
 		static Clock& Instance();
 		//----------elemFunction----------
 		/**
-		 * @brief ½ʱ
-		 * @param _id ʱID
-		 * @param _fps ˢ
+		 * @brief 新建时钟
+		 * @param _id 时钟ID
+		 * @param _fps 刷新率
 		 * @return
 		 */
 		ClockID NewClock(double _fps);
 		/**
-		 * @brief Ƴʱ
-		 * @param _id ʱID
-		 * @return true Ƴɹ
-		 * @return false Ƴʧ
+		 * @brief 移除时钟
+		 * @param _id 时钟ID
+		 * @return true 移除成功
+		 * @return false 移除失败
 		 */
 		bool EraseClock(const ClockID _id);
 		/**
-		 * @brief ʱ
-		 * @param _id ƵʱID
-		 * @return ʱID
+		 * @brief 复制时钟
+		 * @param _id 被复制的时钟ID
+		 * @return 新时钟ID
 		 */
 		ClockID CopyClock(const ClockID _id);
+		/**
+		 * @brief 新建子时钟
+		 *
+		 * 子时钟的暂停状态与缩放率由自身与所有父时钟共同决定，
+		 * 暂停或缩放父时钟只需修改父时钟本身，子时钟在下次计算时生效
+		 * @param _parent 父时钟ID
+		 * @param _fps 刷新率
+		 * @return 新时钟ID
+		 */
+		ClockID NewChildClock(const ClockID _parent, double _fps);
+		/**
+		 * @brief 设置时钟的父时钟
+		 * @param _id 时钟ID
+		 * @param _parent 父时钟ID，为0时解除父子关系
+		 */
+		void SetParent(const ClockID _id, const ClockID _parent);
+		/**
+		 * @brief 获取时钟的父时钟
+		 * @param _id 时钟ID
+		 * @return ClockID 父时钟ID，无父时钟时为0
+		 */
+		ClockID GetParent(const ClockID _id);
 		//----------getFunction----------
 		/**
-		 * @brief ȡʱǷ񳬹µ㣬ʱ
-		 * @param _id ʱID
-		 * @return true ʱҪ
-		 * @return false ʱӲҪ
+		 * @brief 获取时钟是否超过更新点，是则更新时钟
+		 * @param _id 时钟ID
+		 * @return true 时钟需要更新
+		 * @return false 时钟不需要更新
 		 */
 		bool GetUpdate(const ClockID _id);
 		/**
-		 * @brief ȡʱǷͣ
-		 * @param _id ʱID
-		 * @return true ʱͣ
-		 * @return false ʱӲͣ
+		 * @brief 获取时钟是否暂停
+		 * @param _id 时钟ID
+		 * @return true 时钟暂停
+		 * @return false 时钟不暂停
 		 */
 		bool GetPause(const ClockID _id);
 		/**
-		 * @brief ȡʱˢ
-		 * @param _id ʱID
-		 * @return double ˢ
+		 * @brief 获取时钟是否因自身或任一父时钟而暂停
+		 * @param _id 时钟ID
+		 * @return true 时钟暂停
+		 * @return false 时钟不暂停
+		 */
+		bool GetEffectivePause(const ClockID _id);
+		/**
+		 * @brief 获取时钟自身与所有父时钟缩放率的乘积
+		 * @param _id 时钟ID
+		 * @return double 实际缩放率
+		 */
+		double GetEffectiveScale(const ClockID _id);
+		/**
+		 * @brief 获取时钟刷新率
+		 * @param _id 时钟ID
+		 * @return double 刷新率
 		 */
 		double GetFramePerSecond(const ClockID _id);
 		/**
-		 * @brief ȡʱԴľʱ
-		 * @param _id ʱID
-		 * @return double ʱ
+		 * @brief 获取时钟自创建以来经过的绝对时长
+		 * @param _id 时钟ID
+		 * @return double 绝对时长
 		 */
 		double GetElapsed(const ClockID _id);
 		/**
-		 * @brief ȡʱһˢ½ڵ㾭ľʱ
-		 * @param _id ʱID
-		 * @return double ʱ
+		 * @brief 获取时钟自上一刷新节点经过的绝对时长
+		 * @param _id 时钟ID
+		 * @return double 绝对时长
 		 */
 		double GetTick(const ClockID _id);
 		/**
-		 * @brief ȡʱԴʱ
-		 * @param _id ʱID
-		 * @return double ʱ
+		 * @brief 获取时钟自创建以来经过的相对时长
+		 * @param _id 时钟ID
+		 * @return double 相对时长
 		 */
 		double GetElapsedRelative(const ClockID _id);
 		/**
-		 * @brief ȡʱһˢ½ڵ㾭ʱ
-		 * @param _id ʱID
-		 * @return double ʱ
+		 * @brief 获取时钟自上一刷新节点经过的相对时长
+		 * @param _id 时钟ID
+		 * @return double 相对时长
 		 */
 		double GetTickRelative(const ClockID _id);
 		/**
-		 * @brief ʱͣ״̬
-		 * @param _id ʱID
-		 * @param _pause trueʾͣfalseʾ
+		 * @brief 设置时钟暂停状态
+		 * @param _id 时钟ID
+		 * @param _pause true表示暂停，false表示继续
 		 */
 		void SetPause(const ClockID _id, bool _pause);
 		/**
-		 * @brief ʱˢ
-		 * @param _id ʱID
-		 * @param _fps ˢ
+		 * @brief 设置时钟刷新率
+		 * @param _id 时钟ID
+		 * @param _fps 刷新率
 		 */
 		void SetFramePerSecond(const ClockID _id, double _fps);
 		/**
-		 * @brief ʱӵʱ
-		 * @param _id ʱID
-		 * @param _scale ֵ
+		 * @brief 设置时钟的时间缩放
+		 * @param _id 时钟ID
+		 * @param _scale 缩放值
 		 */
 		void SetFrameScale(const ClockID _id, double _scale);
 		/**
-		 * @brief ʱӵļʱ
-		 * @param _id ʱID
+		 * @brief 重置时钟的计时器
+		 * @param _id 时钟ID
 		 */
 		void ResetClockIns(const ClockID _id);
+		//----------fixedStep----------
+		/**
+		 * @brief 设置时钟的固定步长模式
+		 *
+		 * 固定步长模式下时钟累积经过的时间，每次轮询按更新周期补足所有到期的更新（至多 _maxCatchUp 次），
+		 * 超出上限的部分被丢弃，不足一个周期的余量留至下次轮询；事件的时间间隔固定为一个更新周期
+		 * @param _id 时钟ID
+		 * @param _fixed true表示使用固定步长，false表示恢复默认模式
+		 * @param _maxCatchUp 单次轮询最多补足的更新次数
+		 */
+		void SetFixedStep(const ClockID _id, bool _fixed, int _maxCatchUp);
+		/**
+		 * @brief 获取时钟是否使用固定步长
+		 * @param _id 时钟ID
+		 * @return true 固定步长
+		 * @return false 默认模式
+		 */
+		bool GetFixedStep(const ClockID _id);
+		/**
+		 * @brief 获取上次轮询产生的更新次数
+		 * @param _id 时钟ID
+		 * @return int 更新次数
+		 */
+		int GetUpdateCount(const ClockID _id);
+		/**
+		 * @brief 获取固定步长的插值系数，即上次轮询后余量占更新周期的比例
+		 * @param _id 时钟ID
+		 * @return double 插值系数，范围[0, 1)
+		 */
+		double GetInterpolationAlpha(const ClockID _id);
+#ifdef __linux__
+		//----------timerfd----------
+		/**
+		 * @brief 获取时钟更新通知的timerfd，首次调用时创建
+		 *
+		 * timerfd在时钟到达下一更新点时变为可读，可与其他描述符一同加入epoll等待，
+		 * 可读时调用 HandleTimerFd 更新时钟；每次 GetUpdate 后自动设定至新的更新点。
+		 * 虚拟时间模式下timerfd不随虚拟时间推进
+		 * @param _id 时钟ID
+		 * @return int timerfd，失败时为-1
+		 */
+		int GetTimerFd(const ClockID _id);
+		/**
+		 * @brief 处理可读的timerfd并更新时钟
+		 * @param _id 时钟ID
+		 * @return true 时钟发生更新
+		 * @return false 时钟未更新
+		 */
+		bool HandleTimerFd(const ClockID _id);
+#endif // __linux__
+		//----------stats----------
+		/**
+		 * @brief 开启或关闭时钟的运行统计
+		 *
+		 * 统计更新延迟、更新间隔、事件唤起耗时与丢失的更新次数，关闭时清空已有统计
+		 * @param _id 时钟ID
+		 * @param _enable true表示开启，false表示关闭
+		 */
+		void SetClockStats(const ClockID _id, bool _enable);
+		/**
+		 * @brief 获取时钟运行统计快照
+		 * @param _id 时钟ID
+		 * @return ClockStatsSnapshot 统计快照，未开启统计时各项为空
+		 */
+		ClockStatsSnapshot GetClockStats(const ClockID _id);
+		/**
+		 * @brief 清空时钟运行统计
+		 * @param _id 时钟ID
+		 */
+		void ResetClockStats(const ClockID _id);
+		/**
+		 * @brief 以JSON格式输出所有已开启统计的时钟
+		 * @return std::string JSON数组
+		 */
+		std::string DumpClockStats();
+		//----------memory----------
+		/**
+		 * @brief 设置时钟表与此后新建的时钟元素使用的内存资源
+		 *
+		 * 已有时钟元素仍由原资源释放，原资源的生命周期须长于这些时钟
+		 * @param _resource 内存资源，为 nullptr 时使用默认资源
+		 */
+		void SetMemoryResource(std::pmr::memory_resource* _resource);
+		/**
+		 * @brief 获取时钟使用的内存资源
+		 */
+		std::pmr::memory_resource* GetMemoryResource();
+		//----------virtualTime----------
+		/**
+		 * @brief 切换虚拟时间模式
+		 *
+		 * 开启后所有时钟改由虚拟计数驱动，仅在调用 AdvanceVirtualTime / RunVirtualTime 时前进；
+		 * 切换前后时间保持连续，不会产生跳变
+		 * @param _enable true表示使用虚拟时间，false表示恢复真实时间
+		 */
+		void SetVirtualTime(bool _enable);
+		/**
+		 * @brief 获取是否处于虚拟时间模式
+		 * @return true 虚拟时间
+		 * @return false 真实时间
+		 */
+		bool GetVirtualTime();
+		/**
+		 * @brief 推进虚拟时间，不唤起时钟更新
+		 * @param ms 推进的时长（毫秒）
+		 */
+		void AdvanceVirtualTime(double ms);
+		/**
+		 * @brief 以最快速度推进虚拟时间，并依次唤起期间所有到期的时钟
+		 *
+		 * 每次直接跳至最近的更新点，无需等待，时钟与其事件的行为与真实时间一致
+		 * @param ms 推进的时长（毫秒）
+		 * @return int 期间发生的时钟更新次数
+		 */
+		int RunVirtualTime(double ms);
 		/**
-		 * @brief תڵԣ unsigned long long ͵ļתΪ
-		 * @param time_ull unsigned long long ͵ļ
-		 * @return תĺ
+		 * @brief 计数器转换（用于调试），将 unsigned long long 类型的计数器转换为毫秒计数器
+		 * @param time_ull unsigned long long 类型的计数器
+		 * @return 转换后的毫秒计数器
 		 */
 		inline int ull2ms_freq(ull time_ull)
 		{
@@ -345,44 +718,64 @@ namespace TanmiEngine
 
 #ifdef EVENT_SYSTEM
 		/**
-		 * @brief ¼ָʱ
-		 * @param _id ʱID
-		 * @param event ¼ID
+		 * @brief 将事件添加至指定时钟
+		 * @param _id 时钟ID
+		 * @param event 事件ID
 		 */
 		void AddEvent(const ClockID _id, const Event& event);
 		/**
-		* @brief ¼б¼ָʱ
+		* @brief 将事件列表中所有事件添加至指定时钟
 		* 
-		* @tparam T ¼б
-		* @param _id ʱID
-		* @param events ¼б
+		* @tparam T 事件列表类型
+		* @param _id 时钟ID
+		* @param events 事件列表
 		*/
 		template<EventContainer T>
 		void AddEvent(const ClockID _id, const T& events);
 		/**
-		 * @brief Ƴָʱе¼
-		 * @param _id ʱID
-		 * @param event ¼ID
+		 * @brief 移除指定时钟中的事件
+		 * @param _id 时钟ID
+		 * @param event 事件ID
 		 */
 		void RemoveEvent(const ClockID _id, const Event& event);
 		/**
-		 * @brief ȡָʱе¼б
-		 * @param _id ʱID
-		 * @return ¼б
+		 * @brief 设置时钟的自适应刷新率
+		 *
+		 * 开启后时钟在每次更新时检查消息处理器（带有时间参数）的积压，
+		 * 积压数量或最早消息的等待时长超过上限时降低刷新率（不低于 _minFps），积压消退后恢复至设定刷新率；
+		 * 事件的时间间隔始终为实际经过的时间
+		 * @param _id 时钟ID
+		 * @param _enable true表示开启，false表示关闭并恢复设定刷新率
+		 * @param _minFps 允许的最低刷新率
+		 * @param _highWater 积压消息数上限
+		 * @param _maxAgeMs 积压消息等待时长上限（毫秒）
+		 */
+		void SetAdaptiveRate(const ClockID _id, bool _enable, double _minFps, size_t _highWater, double _maxAgeMs);
+		/**
+		 * @brief 获取时钟是否开启自适应刷新率
+		 * @param _id 时钟ID
+		 * @return true 已开启
+		 * @return false 未开启
+		 */
+		bool GetAdaptiveRate(const ClockID _id);
+		/**
+		 * @brief 获取指定时钟中的事件列表
+		 * @param _id 时钟ID
+		 * @return 事件列表
 		 */
 		std::vector<EventID>& GetEventList(const ClockID _id);
 		/**
-		 * @brief ָʱе¼б
-		 * @param _id ʱID
+		 * @brief 清空指定时钟中的事件列表
+		 * @param _id 时钟ID
 		 */
 		void ClearEventList(const ClockID _id);
 #endif // EVENT_SYSTEM
 		/**
-		 * @brief Ϣ
-		 * @param _id ʱID
+		 * @brief 输出调试信息
+		 * @param _id 时钟ID
 		 */
 		void DEBUG(const ClockID _id);
-		~Clock() = default;	///<
+		~Clock() = default;	///<析构函数
 	};
 
 	Clock& Clock::Instance()
@@ -400,8 +793,8 @@ namespace TanmiEngine
 				throw ClockOutOfRangeException();
 			_id = getNewID();
 			auto pair = getCycleAndFreqIns();
-			auto clkelem = std::make_shared<ClockElem>
-				(_id, pair.first, 1.0f / _fps * pair.second, 1.0f, false);
+			auto clkelem = std::allocate_shared<ClockElem>(elemAllocator(),
+				_id, pair.first, 1.0f / _fps * pair.second, 1.0f, false);
 			clockMap[_id] = clkelem;
 		}
 		catch (ClockException& e)
@@ -444,7 +837,7 @@ namespace TanmiEngine
 			if (e.get() == nullptr)
 				throw ClockNotFoundException();
 			new_id = getNewID();
-			auto clkelem = std::make_shared<ClockElem>(*e, new_id, getCycleAndFreqIns().first);
+			auto clkelem = std::allocate_shared<ClockElem>(elemAllocator(), *e, new_id, baseCycle(e));
 			clockMap[new_id] = clkelem;
 		}
 		catch (ClockException& exp)
@@ -455,9 +848,95 @@ namespace TanmiEngine
 		return new_id;
 	}
 
+	inline ClockID Clock::NewChildClock(const ClockID _parent, double _fps = 60.0f)
+	{
+		auto p = this->getIterator(_parent);
+		ClockID _id = 0;
+		try
+		{
+			if (p.get() == nullptr)
+				throw ClockNotFoundException();
+			if (_fps<0 || _fps>MAX_FRAME_RATE_PER_SECOND)
+				throw ClockOutOfRangeException();
+			_id = getNewID();
+			auto clkelem = std::allocate_shared<ClockElem>(elemAllocator(),
+				_id, runningCycle(p), 1.0f / _fps * queryFreq(), 1.0f, false);
+			clkelem->parent.store(p);
+			clockMap[_id] = clkelem;
+		}
+		catch (ClockException& e)
+		{
+			std::cout << "\n::Clock::NewChildClock()" << e.what() << std::endl;
+			return 0;
+		}
+		return _id;
+	}
+
+	inline void Clock::SetParent(const ClockID _id, const ClockID _parent)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			std::shared_ptr<ClockElem> p(nullptr);
+			if (_parent != 0)
+			{
+				p = this->getIterator(_parent);
+				if (p.get() == nullptr)
+					throw ClockNotFoundException();
+				for (auto a = p; a != nullptr; a = a->parent.load())
+				{
+					if (a == e)
+						throw ClockInvalidParentException();
+				}
+			}
+			std::lock_guard<std::mutex> lock(e->lock);
+			std::lock_guard<std::mutex> templock(e->templock);
+			// 将所有计数点平移至新的基准
+			ull old_base = baseCycle(e);
+			ull new_base = p == nullptr ? queryCycle() : runningCycle(p);
+			ull shift = new_base - old_base;
+			e->cycle += shift;
+			e->last_cycle += shift;
+			e->ins_cycle += shift;
+			e->pause_cycle += shift;
+			e->parent.store(p);
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::SetParent()" << exp.what() << std::endl;
+		}
+	}
+
+	inline ClockID Clock::GetParent(const ClockID _id)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			auto p = e->parent.load();
+			return p == nullptr ? 0 : p->id;
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::GetParent()" << exp.what() << std::endl;
+		}
+		return 0;
+	}
+
 	inline bool Clock::GetUpdate(const ClockID _id)
 	{
+#ifdef __linux__
+		auto e = this->getIterator(_id);
+		bool update = this->isUpdate(e);
+		if (e != nullptr && e->timer_fd.load() >= 0)
+			armTimer(e);
+		return update;
+#else
 		return this->isUpdate(_id);
+#endif // __linux__
 	}
 
 	inline bool Clock::GetPause(const ClockID _id)
@@ -475,6 +954,38 @@ namespace TanmiEngine
 		return e->pause;
 	}
 
+	inline bool Clock::GetEffectivePause(const ClockID _id)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			return effectivePause(e);
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::GetEffectivePause()" << exp.what() << std::endl;
+		}
+		return false;
+	}
+
+	inline double Clock::GetEffectiveScale(const ClockID _id)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			return effectiveScale(e);
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::GetEffectiveScale()" << exp.what() << std::endl;
+		}
+		return 0;
+	}
+
 	inline double Clock::GetFramePerSecond(const ClockID _id)
 	{
 		auto e = this->getIterator(_id);
@@ -516,7 +1027,7 @@ namespace TanmiEngine
 			if (e.get() == nullptr)
 				throw ClockNotFoundException();
 			unsigned long long elapsed_cycles =
-				e->relative_tick + (this->getCycleNow(e) - e->cycle) * (double)e->scale;
+				e->relative_tick + (this->getCycleNow(e) - e->cycle) * effectiveScale(e);
 			unsigned long long freq = getFreqNow(e);
 			return (elapsed_cycles * 1000.0f) / freq;
 		}
@@ -554,7 +1065,7 @@ namespace TanmiEngine
 				throw ClockNotFoundException();
 			unsigned long long elapsed_cycles = e->cycle - e->last_cycle;
 			unsigned long long freq = getFreqNow(e);
-			return (elapsed_cycles * 1000) / (double)freq * e->scale;
+			return (elapsed_cycles * 1000) / (double)freq * effectiveScale(e);
 		}
 		catch (ClockException& exp)
 		{
@@ -579,13 +1090,21 @@ namespace TanmiEngine
 				std::lock_guard<std::mutex> lock(e->lock);
 				e->pause_cycle = this->getCycleNow(e);
 				e->pause = true;
+#ifdef __linux__
+				armTimerTree(e);
+#endif // __linux__
 				return;
 			}
 			else
 			{
 				std::lock_guard<std::mutex> lock(e->lock);
 				e->pause = false;
-				e->cycle += this->getCycleNow(e) - e->pause_cycle;
+				auto paused = this->getCycleNow(e) - e->pause_cycle;
+				e->cycle += paused;
+				e->pause_total += paused;
+#ifdef __linux__
+				armTimerTree(e);
+#endif // __linux__
 				return;
 			}
 		}
@@ -606,6 +1125,15 @@ namespace TanmiEngine
 				throw ClockOutOfRangeException();
 			std::lock_guard<std::mutex> lock(e->lock);
 			e->update_tick = 1.0f / _fps * this->getFreqNow(e);
+#ifdef EVENT_SYSTEM
+			e->target_tick = e->update_tick;
+			if (e->max_tick < e->target_tick)
+				e->max_tick = e->target_tick;
+#endif // EVENT_SYSTEM
+#ifdef __linux__
+			if (e->timer_fd.load() >= 0)
+				armTimer(e);
+#endif // __linux__
 		}
 		catch (ClockException& exp)
 		{
@@ -648,6 +1176,347 @@ namespace TanmiEngine
 		}
 	}
 
+	inline void Clock::SetFixedStep(const ClockID _id, bool _fixed, int _maxCatchUp = 5)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			else if (_maxCatchUp < 1)
+				throw ClockOutOfRangeException();
+			std::lock_guard<std::mutex> lock(e->templock);
+			if (_fixed && e->fixed_step == false)
+			{
+				// 从当前时刻开始累积
+				e->cycle = this->baseCycle(e);
+				e->last_cycle = e->cycle;
+				e->alpha = 0;
+			}
+			e->fixed_step = _fixed;
+			e->max_catch_up = _maxCatchUp;
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::SetFixedStep()" << exp.what() << std::endl;
+		}
+	}
+
+	inline bool Clock::GetFixedStep(const ClockID _id)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			return e->fixed_step;
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::GetFixedStep()" << exp.what() << std::endl;
+		}
+		return false;
+	}
+
+	inline int Clock::GetUpdateCount(const ClockID _id)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			return e->update_count;
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::GetUpdateCount()" << exp.what() << std::endl;
+		}
+		return 0;
+	}
+
+	inline double Clock::GetInterpolationAlpha(const ClockID _id)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			return e->alpha;
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::GetInterpolationAlpha()" << exp.what() << std::endl;
+		}
+		return 0;
+	}
+
+#ifdef __linux__
+	inline int Clock::GetTimerFd(const ClockID _id)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			std::lock_guard<std::mutex> lock(e->lock);
+			if (e->timer_fd.load() < 0)
+			{
+				e->timer_fd.store(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC));
+				if (e->timer_fd.load() >= 0)
+					armTimer(e);
+			}
+			return e->timer_fd.load();
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::GetTimerFd()" << exp.what() << std::endl;
+		}
+		return -1;
+	}
+
+	inline bool Clock::HandleTimerFd(const ClockID _id)
+	{
+		auto e = this->getIterator(_id);
+		if (e != nullptr && e->timer_fd.load() >= 0)
+		{
+			ull expirations;
+			while (read(e->timer_fd.load(), &expirations, sizeof(expirations)) > 0);
+		}
+		return GetUpdate(_id);
+	}
+
+	inline void Clock::armTimer(const std::shared_ptr<ClockElem>& i)
+	{
+		itimerspec spec = {};
+		// 自身或父时钟暂停时解除定时，恢复时由 SetPause 重新设定
+		if (effectivePause(i) == false)
+		{
+			ull base = baseCycle(i);
+			ull due = i->cycle + i->update_tick + (i->fixed_step ? 0 : 1);
+			ull delay = due > base ? due - base : 1;
+			ull ns = (ull)(delay * (1e9 / queryFreq()));
+			spec.it_value.tv_sec = ns / 1000000000ull;
+			spec.it_value.tv_nsec = (ns % 1000000000ull) + (ns == 0 ? 1 : 0);
+		}
+		timerfd_settime(i->timer_fd.load(), 0, &spec, nullptr);
+	}
+
+	inline void Clock::armTimerTree(const std::shared_ptr<ClockElem>& i)
+	{
+		for (auto& c : clockMap)
+		{
+			auto& d = c.second;
+			if (d->timer_fd.load() < 0)
+				continue;
+			for (auto a = d; a != nullptr; a = a->parent.load())
+			{
+				if (a == i)
+				{
+					armTimer(d);
+					break;
+				}
+			}
+		}
+	}
+#endif // __linux__
+
+	inline void Clock::SetClockStats(const ClockID _id, bool _enable)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			std::lock_guard<std::mutex> lock(e->templock);
+			if (_enable && e->stats == nullptr)
+				e->stats = std::make_shared<ClockStats>();
+			else if (_enable == false)
+				e->stats = nullptr;
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::SetClockStats()" << exp.what() << std::endl;
+		}
+	}
+
+	inline ClockStatsSnapshot Clock::GetClockStats(const ClockID _id)
+	{
+		ClockStatsSnapshot snapshot;
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			snapshot.id = _id;
+			snapshotStats(e, snapshot);
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::GetClockStats()" << exp.what() << std::endl;
+		}
+		return snapshot;
+	}
+
+	inline void Clock::ResetClockStats(const ClockID _id)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			std::lock_guard<std::mutex> lock(e->templock);
+			if (e->stats != nullptr)
+				e->stats = std::make_shared<ClockStats>();
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::ResetClockStats()" << exp.what() << std::endl;
+		}
+	}
+
+	inline bool Clock::snapshotStats(const std::shared_ptr<ClockElem>& e, ClockStatsSnapshot& snapshot)
+	{
+		std::shared_ptr<ClockStats> stats;
+		{
+			std::lock_guard<std::mutex> lock(e->templock);
+			stats = e->stats;
+		}
+		if (stats == nullptr)
+			return false;
+		snapshot.ticks = stats->ticks.load(std::memory_order_relaxed);
+		snapshot.dropped = stats->dropped.load(std::memory_order_relaxed);
+		snapshot.lateness = stats->lateness.Snapshot();
+		snapshot.interval = stats->interval.Snapshot();
+		snapshot.dispatch = stats->dispatch.Snapshot();
+		return true;
+	}
+
+	inline std::string Clock::DumpClockStats()
+	{
+		// 持有lock_clk复制时钟列表，释放后逐个在templock下读取统计，期间删除的时钟仍可安全读取
+		std::vector<std::pair<ClockID, std::shared_ptr<ClockElem>>> elems;
+		{
+			std::lock_guard<std::mutex> lock(lock_clk);
+			elems.assign(clockMap.begin(), clockMap.end());
+		}
+		std::sort(elems.begin(), elems.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		std::string json = "[";
+		bool first = true;
+		for (auto& [id, e] : elems)
+		{
+			ClockStatsSnapshot snapshot;
+			snapshot.id = id;
+			if (snapshotStats(e, snapshot) == false)
+				continue;
+			if (first == false)
+				json += ",";
+			json += snapshot.ToJson();
+			first = false;
+		}
+		json += "]";
+		return json;
+	}
+
+	inline void Clock::SetMemoryResource(std::pmr::memory_resource* _resource)
+	{
+		if (_resource == nullptr)
+			_resource = std::pmr::get_default_resource();
+		std::lock_guard<std::mutex> lock(lock_clk);
+		RebindResource(clockMap, _resource);
+	}
+
+	inline std::pmr::memory_resource* Clock::GetMemoryResource()
+	{
+		std::lock_guard<std::mutex> lock(lock_clk);
+		return clockMap.get_allocator().resource();
+	}
+
+	inline void Clock::SetVirtualTime(bool _enable)
+	{
+		std::lock_guard<std::mutex> lock(lock_clk);
+		if (_enable == virtual_time.load())
+			return;
+		if (_enable)
+		{
+			// 从当前时刻接续
+			virtual_cycle = queryRealCycle() + real_offset;
+			virtual_time = true;
+		}
+		else
+		{
+			// 保留虚拟时间推进量，避免计数回退
+			real_offset = virtual_cycle - queryRealCycle();
+			virtual_time = false;
+		}
+	}
+
+	inline bool Clock::GetVirtualTime()
+	{
+		return virtual_time.load();
+	}
+
+	inline void Clock::AdvanceVirtualTime(double ms)
+	{
+		try
+		{
+			if (virtual_time.load() == false)
+				throw ClockNotVirtualException();
+			if (ms < 0)
+				throw ClockOutOfRangeException();
+			virtual_cycle += (ull)(ms * queryFreq() / 1000);
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::AdvanceVirtualTime()" << exp.what() << std::endl;
+		}
+	}
+
+	inline int Clock::RunVirtualTime(double ms)
+	{
+		int count = 0;
+		try
+		{
+			if (virtual_time.load() == false)
+				throw ClockNotVirtualException();
+			if (ms < 0)
+				throw ClockOutOfRangeException();
+			const ull end = virtual_cycle + (ull)(ms * queryFreq() / 1000);
+			while (true)
+			{
+				// 寻找最近的更新点
+				ull next = end + 1;
+				const ull now = virtual_cycle;
+				for (auto& c : clockMap)
+				{
+					auto& e = c.second;
+					// 祖先暂停时基准停止，更新点不会到来
+					if (effectivePause(e))
+						continue;
+					// 子时钟的更新点以父时钟运行计数为基准，换算为时间源计数
+					ull base = baseCycle(e);
+					ull due = e->cycle + e->update_tick + (e->fixed_step ? 0 : 1);
+					next = (std::min)(next, due > base ? now + (due - base) : now);
+				}
+				if (next > end)
+					break;
+				if (next > virtual_cycle)
+					virtual_cycle = next;
+				// 唤起所有到期时钟
+				for (auto& c : clockMap)
+				{
+					if (isUpdate(c.second))
+						++count;
+				}
+			}
+			virtual_cycle = end;
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::RunVirtualTime()" << exp.what() << std::endl;
+		}
+		return count;
+	}
+
 	inline void Clock::DEBUG(const ClockID _id = 1)
 	{
 		auto e = this->getIterator(_id);
@@ -661,7 +1530,7 @@ namespace TanmiEngine
 		std::cout << "tick" << (elapsed_cycles * 1000) / (double)freq << "\n\n";
 	}
 
-	Clock::Clock()
+	Clock::Clock() : virtual_time(false), virtual_cycle(0), real_offset(0)
 	{
 		ClockID _id = getNewID();
 		auto pair = getCycleAndFreqIns();
@@ -689,12 +1558,91 @@ namespace TanmiEngine
 	inline std::pair<ull, ull> Clock::getCycleAndFreqIns()
 	{
 		std::lock_guard<std::mutex> lock(lock_clk);
-		QueryPerformanceCounter(&temp_lint_clk);
-		temp_ull_clk = temp_lint_clk.QuadPart;
-		QueryPerformanceFrequency(&temp_lint_clk);
+		temp_ull_clk = queryCycle();
+		temp_lint_clk.QuadPart = queryFreq();
 		return std::pair<ull, ull>(temp_ull_clk, temp_lint_clk.QuadPart);
 	}
 
+	inline ull Clock::queryRealCycle()
+	{
+#ifdef _WIN32
+		lint t;
+		QueryPerformanceCounter(&t);
+		return t.QuadPart;
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>
+			(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif // _WIN32
+	}
+
+	inline ull Clock::queryCycle()
+	{
+		if (virtual_time.load(std::memory_order_acquire))
+			return virtual_cycle.load(std::memory_order_acquire);
+		return queryRealCycle() + real_offset.load(std::memory_order_relaxed);
+	}
+
+	inline ull Clock::queryFreq()
+	{
+#ifdef _WIN32
+		static const ull freq = []()
+			{
+				lint t;
+				QueryPerformanceFrequency(&t);
+				return (ull)t.QuadPart;
+			}();
+		return freq;
+#else
+		return 1000000000ull;
+#endif // _WIN32
+	}
+
+	inline ull Clock::baseCycle(const std::shared_ptr<ClockElem>& i)
+	{
+		auto p = i->parent.load();
+		if (p == nullptr)
+			return queryCycle();
+		return runningCycle(p);
+	}
+
+	inline ull Clock::runningCycle(const std::shared_ptr<ClockElem>& i)
+	{
+		ull now = i->pause ? i->pause_cycle : baseCycle(i);
+		return now - i->pause_total;
+	}
+
+	inline bool Clock::effectivePause(const std::shared_ptr<ClockElem>& i)
+	{
+		for (auto a = i; a != nullptr; a = a->parent.load())
+		{
+			if (a->pause)
+				return true;
+		}
+		return false;
+	}
+
+	inline double Clock::effectiveScale(const std::shared_ptr<ClockElem>& i)
+	{
+		double s = i->scale;
+		for (auto a = i->parent.load(); a != nullptr; a = a->parent.load())
+		{
+			s *= a->scale;
+		}
+		return s;
+	}
+
+	inline void Clock::recordUpdate(ClockStats& stats, ull now, ull due, ull dropped)
+	{
+		const double ns = 1e9 / queryFreq();
+		stats.ticks.fetch_add(1, std::memory_order_relaxed);
+		if (dropped != 0)
+			stats.dropped.fetch_add(dropped, std::memory_order_relaxed);
+		stats.lateness.Record(now > due ? (ull)((now - due) * ns) : 0);
+		if (stats.last_fire != 0)
+			stats.interval.Record((ull)((now - stats.last_fire) * ns));
+		stats.last_fire = now;
+	}
+
 	inline ull& Clock::getCycleNow(const ClockID _id)
 	{
 		std::shared_ptr<ClockElem> i(nullptr);
@@ -704,7 +1652,7 @@ namespace TanmiEngine
 			if (i.get() == nullptr)
 				throw ClockNotFoundException();
 			std::lock_guard<std::mutex> lock(i->templock);
-			QueryPerformanceCounter(&i->temp_lint);
+			i->temp_lint.QuadPart = baseCycle(i);
 			i->temp_ull = i->temp_lint.QuadPart;
 			return i->temp_ull;
 		}
@@ -723,7 +1671,7 @@ namespace TanmiEngine
 			if (i.get() == nullptr)
 				throw ClockNotFoundException();
 			std::lock_guard<std::mutex> lock(i->templock);
-			QueryPerformanceCounter(&i->temp_lint);
+			i->temp_lint.QuadPart = baseCycle(i);
 			i->temp_ull = i->temp_lint.QuadPart;
 			return i->temp_ull;
 		}
@@ -745,7 +1693,7 @@ namespace TanmiEngine
 				throw ClockNotFoundException();
 
 			std::lock_guard<std::mutex> lock(i->templock);
-			QueryPerformanceFrequency(&i->temp_lint);
+			i->temp_lint.QuadPart = queryFreq();
 			i->temp_ull = i->temp_lint.QuadPart;
 
 			return i->temp_ull;
@@ -766,7 +1714,7 @@ namespace TanmiEngine
 				throw ClockNotFoundException();
 
 			std::lock_guard<std::mutex> lock(i->templock);
-			QueryPerformanceFrequency(&i->temp_lint);
+			i->temp_lint.QuadPart = queryFreq();
 			i->temp_ull = i->temp_lint.QuadPart;
 
 			return i->temp_ull;
@@ -781,82 +1729,96 @@ namespace TanmiEngine
 
 	inline bool Clock::isUpdate(const ClockID _id)
 	{
-		std::shared_ptr<ClockElem> i(nullptr);
+		return isUpdate(getIterator(_id));
+	}
+
+	inline bool Clock::isUpdate(std::shared_ptr<ClockElem> i)
+	{
 		try
 		{
-			i = getIterator(_id);
 			if (i.get() == nullptr)
 				throw ClockNotFoundException();
 
 			if (i->pause == true)
 			{
+				i->update_count = 0;
 				return false;
 			}
 			std::lock_guard<std::mutex> lock(i->templock);
-			QueryPerformanceCounter(&i->temp_lint);
-			if (i->temp_lint.QuadPart - i->cycle > i->update_tick)
+			i->temp_lint.QuadPart = baseCycle(i);
+			if (i->fixed_step)
 			{
+				// 按更新周期补足累积的时间
+				ull now = i->temp_lint.QuadPart;
+				ull due = now >= i->cycle ? (now - i->cycle) / i->update_tick : 0;
+				ull count = (std::min)(due, (ull)i->max_catch_up);
+				if (count == 0)
+				{
+					i->update_count = 0;
+					i->alpha = (double)(now - i->cycle) / i->update_tick;
+					return false;
+				}
+				if (i->stats != nullptr)
+					recordUpdate(*i->stats, now, i->cycle + i->update_tick, due - count);
 				i->last_cycle = i->cycle;
-				i->cycle = i->temp_lint.QuadPart;
-				auto relative_passed = (i->cycle - i->last_cycle) * i->scale;
-				i->relative_tick += relative_passed;
+				// 超出补帧上限的部分直接丢弃
+				i->cycle += due * i->update_tick;
+				i->update_count = (int)count;
+				i->alpha = (double)(now - i->cycle) / i->update_tick;
+				auto relative_passed = i->update_tick * effectiveScale(i);
+				i->relative_tick += relative_passed * count;
 #ifdef EVENT_SYSTEM
 				EventSystem& eventSystem = EventSystem::Instance();
-				QueryPerformanceFrequency(&i->temp_lint);
-				auto freq = i->temp_lint.QuadPart;
+				auto freq = queryFreq();
+				ull dispatch_begin = i->stats != nullptr ? queryRealCycle() : 0;
 				std::lock_guard<std::mutex> lock(i->lock);
-				for (auto e : i->eventList)
+				for (ull n = 0; n < count; ++n)
 				{
-					eventSystem.TriggerEventUpdate(e, relative_passed * 1000 / freq);
+					for (auto e : i->eventList)
+					{
+						eventSystem.TriggerEventUpdate(e, relative_passed * 1000 / freq);
+					}
 				}
+				if (i->stats != nullptr)
+					i->stats->dispatch.Record((ull)((queryRealCycle() - dispatch_begin) * 1e9 / freq));
+				if (i->adaptive)
+					adaptRate(i);
 #endif // EVENT_SYSTEM
 				return true;
 			}
-			else
-			{
-				return false;
-			}
-		}
-		catch (ClockException& exp)
-		{
-			std::cout << "\n::Clock::isUpdate()" << exp.what() << std::endl;
-		}
-		return false;
-	}
-
-	inline bool Clock::isUpdate(std::shared_ptr<ClockElem> i)
-	{
-		try
-		{
-			if (i.get() == nullptr)
-				throw ClockNotFoundException();
-
-			if (i->pause == true)
-			{
-				return false;
-			}
-			std::lock_guard<std::mutex> lock(i->templock);
-			QueryPerformanceCounter(&i->temp_lint);
 			if (i->temp_lint.QuadPart - i->cycle > i->update_tick)
 			{
+				if (i->stats != nullptr)
+				{
+					ull passed = i->temp_lint.QuadPart - i->cycle;
+					recordUpdate(*i->stats, i->temp_lint.QuadPart, i->cycle + i->update_tick,
+						passed / i->update_tick - 1);
+				}
 				i->last_cycle = i->cycle;
 				i->cycle = i->temp_lint.QuadPart;
-				auto relative_passed = (i->cycle - i->last_cycle) * i->scale;
+				i->update_count = 1;
+				auto relative_passed = (i->cycle - i->last_cycle) * effectiveScale(i);
 				i->relative_tick += relative_passed;
 #ifdef EVENT_SYSTEM
 				EventSystem& eventSystem = EventSystem::Instance();
-				QueryPerformanceFrequency(&i->temp_lint);
+				i->temp_lint.QuadPart = queryFreq();
 				auto freq = i->temp_lint.QuadPart;
+				ull dispatch_begin = i->stats != nullptr ? queryRealCycle() : 0;
 				std::lock_guard<std::mutex> lock(i->lock);
 				for (auto e : i->eventList)
 				{
 					eventSystem.TriggerEventUpdate(e, relative_passed * 1000 / freq);
 				}
+				if (i->stats != nullptr)
+					i->stats->dispatch.Record((ull)((queryRealCycle() - dispatch_begin) * 1e9 / freq));
+				if (i->adaptive)
+					adaptRate(i);
 #endif // EVENT_SYSTEM
 				return true;
 			}
 			else
 			{
+				i->update_count = 0;
 				return false;
 			}
 		}
@@ -939,6 +1901,83 @@ namespace TanmiEngine
 		}
 	}
 
+	inline void Clock::SetAdaptiveRate(const ClockID _id, bool _enable, double _minFps = 1.0, size_t _highWater = 1024, double _maxAgeMs = 100.0)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			std::lock_guard<std::mutex> lock(e->templock);
+			if (_enable)
+			{
+				if (_minFps<MIN_FRAME_RATE_PER_SECOND || _minFps>MAX_FRAME_RATE_PER_SECOND || _maxAgeMs <= 0)
+					throw ClockOutOfRangeException();
+				if (e->adaptive == false)
+					e->target_tick = e->update_tick;
+				e->max_tick = (std::max)(e->target_tick, (ull)(1.0 / _minFps * queryFreq()));
+				e->high_water = _highWater;
+				e->max_age = _maxAgeMs;
+				e->adaptive = true;
+			}
+			else if (e->adaptive)
+			{
+				e->update_tick = e->target_tick;
+				e->adaptive = false;
+			}
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::SetAdaptiveRate()" << exp.what() << std::endl;
+		}
+	}
+
+	inline bool Clock::GetAdaptiveRate(const ClockID _id)
+	{
+		auto e = this->getIterator(_id);
+		try
+		{
+			if (e.get() == nullptr)
+				throw ClockNotFoundException();
+			return e->adaptive;
+		}
+		catch (ClockException& exp)
+		{
+			std::cout << "\n::Clock::GetAdaptiveRate()" << exp.what() << std::endl;
+		}
+		return false;
+	}
+
+	inline void Clock::adaptRate(const std::shared_ptr<ClockElem>& i)
+	{
+		// 采样时钟事件实际路由至的处理器，取积压最重者；调用者持有i->lock
+		EventSystem& eventSystem = EventSystem::Instance();
+		size_t backlog = 0;
+		double age = 0;
+		MessageHandlerUpdate* sampled = nullptr;
+		for (auto e : i->eventList)
+		{
+			auto handler = eventSystem.GetEventHandlerUpdate(e);
+			if (handler == nullptr || handler.get() == sampled)
+				continue;
+			sampled = handler.get();
+			backlog = (std::max)(backlog, handler->GetBacklog());
+			age = (std::max)(age, handler->GetBacklogAge());
+		}
+		if (sampled == nullptr)
+			return;
+		if (backlog > i->high_water || age > i->max_age)
+		{
+			// 过载：刷新率减半
+			i->update_tick = (std::min)(i->max_tick, i->update_tick * 2);
+		}
+		else if (backlog <= i->high_water / 4 && age <= i->max_age / 4 && i->update_tick > i->target_tick)
+		{
+			// 积压消退：逐步恢复
+			i->update_tick = (std::max)(i->target_tick, i->update_tick * 4 / 5);
+		}
+	}
+
 	inline std::vector<EventID>& Clock::GetEventList(const ClockID _id)
 	{
 		std::shared_ptr<ClockElem> i(nullptr);
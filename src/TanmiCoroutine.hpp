@@ -0,0 +1,257 @@
+#pragma once
+/*****************************************************************//**
+ * \file   TanmiCoroutine.hpp
+ * \brief  事件系统的协程支持
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <coroutine>
+#include <initializer_list>
+#include <unordered_map>
+
+#include "TanmiEventSystem.hpp"
+
+namespace TanmiEngine
+{
+	/**
+	 * @brief 协程等待事件的结果
+	 */
+	struct EventResult
+	{
+		EventID id = 0;			///< 触发的事件ID
+		double ms = 0;			///< 事件发生所经过的时间（以毫秒为单位），由TriggerEvent触发时为0
+		bool update = false;	///< 是否由TriggerEventUpdate触发
+	};
+
+	/**
+	 * @brief 协程帧内存池，按64字节对齐的大小分桶复用
+	 */
+	class CoroutineFramePool
+	{
+	public:
+		/**
+		 * @brief 获取CoroutineFramePool实例引用
+		 */
+		static CoroutineFramePool& Instance()
+		{
+			static CoroutineFramePool pool;
+			return pool;
+		}
+		/**
+		 * @brief 分配协程帧
+		 *
+		 * @param size 帧大小
+		 * @return void* 帧内存
+		 */
+		void* Allocate(size_t size)
+		{
+			size = roundUp(size);
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				auto& list = freeList[size];
+				if (list.empty() == false)
+				{
+					void* frame = list.back();
+					list.pop_back();
+					return frame;
+				}
+			}
+			return ::operator new(size);
+		}
+		/**
+		 * @brief 归还协程帧
+		 *
+		 * @param frame 帧内存
+		 * @param size 帧大小
+		 */
+		void Deallocate(void* frame, size_t size)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			freeList[roundUp(size)].push_back(frame);
+		}
+		/**
+		 * @brief 析构函数，释放所有缓存的帧
+		 */
+		~CoroutineFramePool()
+		{
+			for (auto& list : freeList)
+			{
+				for (void* frame : list.second)
+					::operator delete(frame);
+			}
+		}
+	private:
+		CoroutineFramePool() = default;
+		static size_t roundUp(size_t size)
+		{
+			return (size + 63) & ~size_t(63);
+		}
+		std::unordered_map<size_t, std::vector<void*>> freeList;	//< 各大小的空闲帧
+		std::mutex mtx;												//< 互斥锁
+	};
+
+	/**
+	 * @brief 由事件驱动的协程返回类型
+	 *
+	 * 协程创建后立即执行，直至第一次co_await；恢复发生在消息处理器的处理线程（或调用Poll/Pump的线程）中，
+	 * 协程帧由 CoroutineFramePool 分配
+	 */
+	class EventTask
+	{
+	public:
+		struct promise_type
+		{
+			EventTask get_return_object() noexcept
+			{
+				return {};
+			}
+			std::suspend_never initial_suspend() noexcept
+			{
+				return {};
+			}
+			std::suspend_never final_suspend() noexcept
+			{
+				return {};
+			}
+			void return_void() noexcept
+			{}
+			void unhandled_exception()
+			{
+				try
+				{
+					throw;
+				}
+				catch (std::exception& e)
+				{
+					std::cout << "::EventTask" << e.what() << std::endl;
+				}
+			}
+			static void* operator new(size_t size)
+			{
+				return CoroutineFramePool::Instance().Allocate(size);
+			}
+			static void operator delete(void* frame, size_t size)
+			{
+				CoroutineFramePool::Instance().Deallocate(frame, size);
+			}
+		};
+	};
+
+	/**
+	 * @brief 协程等待使用的监听器，每次等待使用新的监听器
+	 *
+	 * 监听器不在等待间复用：取消订阅前已入队的消息可能在下一次等待开始后才被处理，复用会以过期的结果恢复协程
+	 */
+	class AwaitListener : public Listener, public std::enable_shared_from_this<AwaitListener>
+	{
+	public:
+		virtual void WakeEvent(const EventID event)
+		{
+			fire(event, 0, false);
+		}
+		virtual void WakeEventUpdate(const EventID event, double ms)
+		{
+			fire(event, ms, true);
+		}
+		/**
+		 * @brief 订阅事件并在触发时恢复协程
+		 *
+		 * @param _handle 待恢复的协程
+		 */
+		void Arm(std::coroutine_handle<> _handle);
+
+		std::vector<EventID> events;	///< 等待的事件，仅在 Arm 之前写入
+		EventResult result;				///< 等待结果
+	private:
+		/**
+		 * @brief 首次触发时取消订阅并恢复协程，之后的触发被忽略
+		 */
+		void fire(const EventID event, double ms, bool update);
+
+		std::coroutine_handle<> handle;			//< 待恢复的协程
+		std::atomic<bool> armed{ false };		//< 是否正在等待
+	};
+
+	/**
+	 * @brief 等待事件触发的co_await对象
+	 *
+	 * 使用示例：
+	 * @code
+	 * EventTask Turn()
+	 * {
+	 *     auto result = co_await EventSystem::Next(*roundBegin);
+	 *     // 在处理线程中恢复，result.ms 为事件的时间参数
+	 * }
+	 * @endcode
+	 */
+	class EventAwaiter
+	{
+	public:
+		EventAwaiter(std::initializer_list<EventID> _events) :
+			listener(std::make_shared<AwaitListener>())
+		{
+			listener->events.assign(_events.begin(), _events.end());
+		}
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			// 订阅完成后事件可能立即在其他线程触发，此后不可再访问本对象
+			auto l = listener;
+			l->Arm(handle);
+		}
+		EventResult await_resume() const noexcept
+		{
+			return listener->result;
+		}
+	private:
+		std::shared_ptr<AwaitListener> listener;	//< 等待使用的监听器
+	};
+
+	inline void AwaitListener::Arm(std::coroutine_handle<> _handle)
+	{
+		handle = _handle;
+		armed.store(true, std::memory_order_release);
+		EventSystem& eventSystem = EventSystem::Instance();
+		auto self = shared_from_this();
+		Event event;
+		for (auto id : events)
+		{
+			event.ID = id;
+			eventSystem.AddEventHandler(event, self);
+		}
+		// 订阅期间已被其他线程触发时，fire可能先于部分订阅完成，需补充取消
+		if (armed.load(std::memory_order_acquire) == false)
+		{
+			for (auto id : events)
+			{
+				eventSystem.RemoveEventHandlerNoException(id, self);
+			}
+		}
+	}
+
+	inline void AwaitListener::fire(const EventID event, double ms, bool update)
+	{
+		bool expected = true;
+		if (armed.compare_exchange_strong(expected, false, std::memory_order_acq_rel) == false)
+			return;
+		EventSystem& eventSystem = EventSystem::Instance();
+		auto self = shared_from_this();
+		for (auto id : events)
+		{
+			eventSystem.RemoveEventHandlerNoException(id, self);
+		}
+		result = EventResult{ event, ms, update };
+		handle.resume();
+	}
+
+	template<typename... Events>
+	inline EventAwaiter EventSystem::Next(const Event& event, const Events&... events)
+	{
+		static_assert((std::is_base_of_v<Event, Events> && ...), "Events must be derived from Event");
+		return EventAwaiter{ event.ID, events.ID... };
+	}
+}
\ No newline at end of file
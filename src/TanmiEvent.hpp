@@ -1,39 +1,106 @@
 #pragma once
 /*****************************************************************//**
  * \file   TanmiEvent.hpp
- * \brief  ¼
+ * \brief  事件基类
  * 
  * \author tanmika
  * \date   April 2023
  *********************************************************************/
+#include <cstdint>
+#include <string_view>
+
 using EventID = int;
 namespace TanmiEngine {
+	constexpr EventID STATIC_EVENT_FLAG = 0x40000000;	///< 静态事件ID的标志位，运行时注册的事件ID不会使用该范围
+
 	/**
-	 * @brief ¼
+	 * @brief 由事件名计算静态事件ID（FNV-1a），结果位于 STATIC_EVENT_FLAG 标志的保留范围内
+	 *
+	 * @param name 事件名
+	 * @return EventID 静态事件ID，与注册顺序及编译单元无关
+	 */
+	constexpr EventID StaticEventID(std::string_view name)
+	{
+		std::uint32_t hash = 2166136261u;
+		for (char c : name)
+		{
+			hash ^= (std::uint8_t)c;
+			hash *= 16777619u;
+		}
+		return (EventID)(hash & (STATIC_EVENT_FLAG - 1)) | STATIC_EVENT_FLAG;
+	}
+
+	/**
+	 * @brief 判断事件ID是否为静态事件ID
+	 */
+	constexpr bool IsStaticEvent(EventID id)
+	{
+		return (id & STATIC_EVENT_FLAG) != 0;
+	}
+
+	/**
+	 * @brief 事件基类
 	 */
 	class Event
 	{
 	public:
 		/**
-		 * @brief 캯ʼ¼IDΪ0
+		 * @brief 构造函数，初始化事件ID为0
 		 * 
 		 */
-		Event() :ID(0)
+		constexpr Event() :ID(0)
 		{}
 		/**
-		* @brief Ĭ
+		 * @brief 以指定ID构造事件，用于静态事件
+		 *
+		 * @param id 事件ID
+		 */
+		constexpr explicit Event(EventID id) :ID(id)
+		{}
+		/**
+		* @brief 默认析构函数
 		*/
 		~Event() = default;
 		/**
-		 * @brief ԤʵԤ߼
+		 * @brief 预处理函数，用于实现预处理逻辑
 		 *
-		 * @return true Ԥɹִ¼
-		 * @return false Ԥʧܣִ¼
+		 * @return true 预处理成功，执行事件
+		 * @return false 预处理失败，不执行事件
 		 */
 		virtual bool preProcess()
 		{
 			return true;
 		}
-		EventID ID;	///< ¼ID
+		EventID ID;	///< 事件ID
 	};
-}
\ No newline at end of file
+
+	/**
+	 * @brief 判断一组静态事件的ID互不相同，用于在编译期检查名称散列冲突
+	 */
+	template<typename... E>
+	consteval bool StaticEventsDistinct(const E&... events)
+	{
+		EventID ids[] = { events.ID... };
+		for (size_t i = 0; i < sizeof...(E); ++i)
+		{
+			for (size_t j = i + 1; j < sizeof...(E); ++j)
+			{
+				if (ids[i] == ids[j])
+					return false;
+			}
+		}
+		return true;
+	}
+}
+
+/**
+ * @brief 声明静态事件，ID在编译期由事件名散列得到，无需注册
+ *
+ * 静态事件不经过预处理，可直接绑定与触发，如 eventSystem.TriggerEvent(PlayerJoined)
+ */
+#define TANMI_EVENT(name) inline constexpr ::TanmiEngine::Event name{ ::TanmiEngine::StaticEventID(#name) }
+
+/**
+ * @brief 在编译期检查一组静态事件的ID互不相同
+ */
+#define TANMI_EVENT_ASSERT_DISTINCT(...) static_assert(::TanmiEngine::StaticEventsDistinct(__VA_ARGS__), "static event ID collision")
\ No newline at end of file
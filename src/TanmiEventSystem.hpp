@@ -1,25 +1,37 @@
 #pragma once
 /*****************************************************************//**
  * \file   TanmiEventSystem.hpp
- * \brief  첽¼ϵͳ
+ * \brief  异步事件处理系统
  * 
  * \author tanmi
  * \email tanmika@foxmail.com
  * \date   April 2023
  *********************************************************************/
+#include <algorithm>
+#include <bit>
 #include <map>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <memory>
 #include <iostream>
 #include <vector>
 #include <functional>
+#include <thread>
 
 #include "TanmiMessageHandler.hpp"
+#include "TanmiSubscriptionMatrix.hpp"
+#include "TanmiStaticListener.hpp"
+#include "TanmiMetrics.hpp"
+#include "TanmiJournal.hpp"
+#include "TanmiMemory.hpp"
 
 #define EVENT_SYSTEM
 namespace TanmiEngine
 {
 	/**
-	 * @brief EventSystem 쳣ࡣ
+	 * @brief EventSystem 类异常基类。
 	 */
 	class EventSystemException : public std::exception
 	{
@@ -30,7 +42,7 @@ namespace TanmiEngine
 		}
 	};
 	/**
-	* @brief  ¼δҵ쳣
+	* @brief  事件未找到异常
 	*/
 	class EventSystemEventNotFoundException : public EventSystemException
 	{
@@ -41,7 +53,7 @@ namespace TanmiEngine
 		}
 	};
 	/**
-	 * @brief  δҵ쳣
+	 * @brief  监听器未找到异常
 	 */
 	class EventSystemListenerNotFoundException : public EventSystemException
 	{
@@ -52,7 +64,7 @@ namespace TanmiEngine
 		}
 	};
 	/**
-	 * @brief	¼δע쳣
+	 * @brief	事件未注册异常
 	 */
 	class EventSystemEventNotRegistedException : public EventSystemException
 	{
@@ -62,28 +74,39 @@ namespace TanmiEngine
 			return "::Expection event_not_regist.";
 		}
 	};
+	/**
+	 * @brief	处理管线数量超出上限异常
+	 */
+	class EventSystemRouteOverflowException : public EventSystemException
+	{
+	public:
+		virtual const char* what () const throw ()
+		{
+			return "::Expection route_overflow.";
+		}
+	};
 
-	// 
+	// 概念定义
 	/**
-	 * @brief ¼
+	 * @brief 事件基类概念
 	 */
 	template<typename T>
 	concept EventBase = std::is_base_of_v<Event, T>;
 
 	/**
-	 * @brief Ϣ
+	 * @brief 消息处理器基类概念
 	 */
 	template<typename T>
 	concept MessageHandlerBase = std::is_base_of_v<MessageHandler, T>;
 
 	/**
-	 * @brief Ϣ»
+	 * @brief 消息处理器更新基类概念
 	 */
 	template<typename T>
 	concept MessageHandlerUpdateBase = std::is_base_of_v<MessageHandlerUpdate, T>;
 
 	/**
-	 * @brief ˳ȡ
+	 * @brief 可顺序读取的容器概念
 	 */
 	template<typename Container>
 	concept InputRangeContainer = requires(Container c)
@@ -92,7 +115,7 @@ namespace TanmiEngine
 	};
 
 	/**
-	 * @brief ˳ȡ¼
+	 * @brief 可顺序读取的事件容器概念
 	 */
 	template<typename Container>
 	concept EventContainer = requires(Container c)
@@ -103,7 +126,7 @@ namespace TanmiEngine
 	};
 
 	/**
-	 * @brief ˳ȡļָ
+	 * @brief 可顺序读取的监听器指针容器概念
 	 */
 	template<typename Container>
 	concept ListenerSptrContainer = requires(Container c)
@@ -113,264 +136,916 @@ namespace TanmiEngine
 			requires std::ranges::input_range<Container>;
 	};
 
+	class EventAwaiter;
+
 	/**
-	 * @brief ¼ϵͳ
+	 * @brief 事件系统类
 	 */
 	class EventSystem
 	{
 	private:
-		// ݳԱ
-		std::multimap<EventID, std::weak_ptr<Listener>> EventList;	//< ¼б<¼ID, ָ>
-		std::vector<std::shared_ptr<Listener>> listenersToWake;		//< ѵļб
-		std::vector<std::function<bool()>> eventsPreprocess;		//< ¼Ԥб
-		std::mutex mtx;												//< 
-		std::mutex mtx_temp;										//< ʱ
+		// 数据成员
+		std::pmr::multimap<EventID, std::weak_ptr<Listener>> EventList;	//< 事件列表，<事件ID, 监听器指针>
+		std::pmr::vector<std::shared_ptr<Listener>> listenersToWake;	//< 待唤醒的监听器列表
+		std::pmr::vector<Event> eventsPreprocess;					//< 事件预处理列表，保存注册时事件的副本
+		mutable std::mutex mtx;										//< 互斥锁
+		std::mutex mtx_temp;										//< 临时互斥锁
+		std::map<std::string, EventID, std::less<>> topics;			//< 主题列表，<主题, 事件ID>
+		std::vector<std::pair<std::string, std::weak_ptr<Listener>>> topicHandlers;	//< 主题订阅列表，<主题模式, 监听器指针>
+		SubscriptionMatrix matrix;									//< 订阅位矩阵
+		bool useMatrix = false;										//< 批量触发是否使用订阅位矩阵
+		bool matrixDirty = true;									//< 事件列表变化后矩阵需重建
+		std::pmr::vector<uint64_t> matrixAcc;						//< 批量触发的订阅者并集
+		std::pmr::vector<const uint64_t*> matrixRows;				//< 批量触发的各事件所在行
+		std::pmr::vector<EventID> batchEvents;						//< 批量触发中通过预处理的事件
+		std::pmr::vector<std::pair<std::shared_ptr<Listener>, size_t>> batchTargets;	//< 批量触发的<监听器, 事件在batchEvents中的下标>缓冲
+		std::pmr::vector<EventID> batchSubset;						//< 批量触发中发往单个监听器的事件子集
+		std::pmr::vector<EventID> batchPart;						//< 批量消息按处理器拆分时当前处理器的部分
+		std::pmr::vector<EventID> batchRest;						//< 批量消息按处理器拆分时尚未发送的部分
+#ifdef TANMI_METRICS
+		ShardedCounter metricTriggers;								//< 触发调用次数
+		ShardedCounter metricSuppressed;							//< 被预处理拦截的次数
+		ShardedCounter metricNotFound;								//< 事件没有监听器的次数
+		ShardedCounter metricPosted;								//< 发送的消息数量
+		std::unordered_map<EventID, EventMetricsSnapshot> eventMetrics;	//< 各事件指标，由mtx保护
+#endif // TANMI_METRICS
 	private:
-		// ϵͳ
-		std::shared_ptr<MessageHandler> messageHandler;				//< Ϣ
-		bool isMessageHandlerRegisted = false;						//< ǷעϢ
-		std::shared_ptr<MessageHandlerUpdate> messageHandlerUpdate;	//< Ϣʱ
-		bool isMessageHandlerUpdateRegisted = false;				//< ǷעϢʱ
+		// 其他系统
+		std::shared_ptr<MessageHandler> messageHandler;				//< 消息处理器
+		bool isMessageHandlerRegisted = false;						//< 是否注册了消息处理器
+		std::shared_ptr<MessageHandlerUpdate> messageHandlerUpdate;	//< 消息处理器（带有时间参数）
+		bool isMessageHandlerUpdateRegisted = false;				//< 是否注册了消息处理器（带有时间参数）
+		/**
+		 * @brief 具名处理管线，拥有各自的处理线程、队列与指标
+		 */
+		struct HandlerRoute
+		{
+			std::string name;										//< 管线名称
+			std::shared_ptr<MessageHandler> handler;				//< 消息处理器，为空时使用默认处理器
+			std::shared_ptr<MessageHandlerUpdate> handlerUpdate;	//< 消息处理器（带有时间参数），为空时使用默认处理器
+		};
+		std::vector<HandlerRoute> routes;							//< 具名处理管线列表，下标为路由号，0号位保留给默认处理器
+		std::pmr::vector<uint16_t> eventRoutes;						//< 事件路由列表，<事件ID, 路由号>，超出范围时为0
+		std::pmr::unordered_map<EventID, uint16_t> staticRoutes;	//< 静态事件路由列表，<静态事件ID, 路由号>，不存在时为0
+		std::vector<std::pair<std::string, uint16_t>> topicRoutes;	//< 主题路由列表，<主题模式, 路由号>
 	private:
 		/**
-		 * @brief 캯ĬռԤб0λ
+		 * @brief 构造函数，默认占据预处理列表0号位
 		 */
 		EventSystem()
 		{
 			eventsPreprocess.emplace_back();
+			routes.emplace_back();
 		}
-		EventSystem(const EventSystem&) = delete;					//< ֹ
-		EventSystem& operator=(const EventSystem&) = delete;		//< ֵֹ
-		EventSystem(EventSystem&&) = delete;						//< ֹƶ
-		EventSystem& operator=(EventSystem&&) = delete;				//< ֹƶֵ
+		EventSystem(const EventSystem&) = delete;					//< 禁止拷贝构造
+		EventSystem& operator=(const EventSystem&) = delete;		//< 禁止拷贝赋值
+		EventSystem(EventSystem&&) = delete;						//< 禁止移动构造
+		EventSystem& operator=(EventSystem&&) = delete;				//< 禁止移动赋值
+		/**
+		 * @brief 执行事件的预处理，静态事件不经过预处理
+		 */
+		bool preProcess(EventID id)
+		{
+			return IsStaticEvent(id) || eventsPreprocess[id].preProcess();
+		}
+		/**
+		 * @brief 寻找事件的监听器并执行预处理，通过后将存活的监听器压入 listenersToWake，同时移除已失效的监听，需持有mtx与mtx_temp
+		 *
+		 * @param id 事件ID
+		 * @return true 通过预处理
+		 * @return false 被预处理拦截
+		 * @throw EventSystemEventNotFoundException 事件没有监听器
+		 */
+		bool collectListeners(EventID id)
+		{
+			auto range = EventList.equal_range(id);
+			if (range.first == range.second)
+			{
+				TANMI_METRIC(metricNotFound.Add());
+				throw EventSystemEventNotFoundException();
+			}
+			if (preProcess(id) == false)
+			{
+				TANMI_METRIC(metricSuppressed.Add());
+				return false;
+			}
+			for (auto it = range.first; it != range.second;)
+			{
+				if (!it->second.expired())
+				{
+					listenersToWake.push_back(it->second.lock());
+					it++;
+				}
+				else
+				{
+					EventList.erase(it++);
+				}
+			}
+			return true;
+		}
+		/**
+		 * @brief 获取事件的路由号，静态事件ID的范围超出路由列表，单独查找，需持有mtx
+		 */
+		uint16_t routeIndexOf(EventID id) const
+		{
+			if (IsStaticEvent(id))
+			{
+				auto it = staticRoutes.find(id);
+				return it == staticRoutes.end() ? 0 : it->second;
+			}
+			if (id > 0 && (size_t)id < eventRoutes.size())
+				return eventRoutes[id];
+			return 0;
+		}
+		/**
+		 * @brief 获取事件路由至的消息处理器，需持有mtx
+		 */
+		MessageHandler& handlerOf(EventID id)
+		{
+			auto& route = routes[routeIndexOf(id)];
+			if (route.handler)
+				return *route.handler;
+			return *messageHandler;
+		}
+		/**
+		 * @brief 获取事件路由至的消息处理器（带有时间参数），需持有mtx
+		 */
+		MessageHandlerUpdate& handlerUpdateOf(EventID id)
+		{
+			auto& route = routes[routeIndexOf(id)];
+			if (route.handlerUpdate)
+				return *route.handlerUpdate;
+			return *messageHandlerUpdate;
+		}
+		/**
+		 * @brief 获取名称对应的路由号，不存在时新建，需持有mtx
+		 */
+		uint16_t routeOf(std::string_view name)
+		{
+			for (size_t i = 1; i < routes.size(); ++i)
+			{
+				if (routes[i].name == name)
+					return (uint16_t)i;
+			}
+			if (routes.size() > UINT16_MAX)
+				throw EventSystemRouteOverflowException();
+			routes.push_back(HandlerRoute{ std::string(name), nullptr, nullptr });
+			return (uint16_t)(routes.size() - 1);
+		}
+		/**
+		 * @brief 设置事件的路由号，需持有mtx
+		 */
+		void setRoute(EventID id, uint16_t route)
+		{
+			if (IsStaticEvent(id))
+			{
+				if (route == 0)
+					staticRoutes.erase(id);
+				else
+					staticRoutes[id] = route;
+				return;
+			}
+			if ((size_t)id >= eventRoutes.size())
+			{
+				if (route == 0)
+					return;
+				eventRoutes.resize((size_t)id + 1, 0);
+			}
+			eventRoutes[id] = route;
+		}
+		/**
+		 * @brief 发送批量消息，事件路由至不同处理器时按处理器拆分，各部分保持事件顺序，需持有mtx与mtx_temp
+		 */
+		void postBatch(const std::shared_ptr<Listener>& listener, std::span<const EventID> subset)
+		{
+			MessageHandler* handler = &handlerOf(subset.front());
+			if (routes.size() == 1 || std::all_of(subset.begin() + 1, subset.end(), [&](EventID id) { return &handlerOf(id) == handler; }))
+			{
+				handler->PostBatch(listener, subset);
+				return;
+			}
+			// 每轮取出首个事件所在处理器的全部事件，其余事件原位前移留待下一轮
+			batchRest.assign(subset.begin(), subset.end());
+			while (batchRest.empty() == false)
+			{
+				handler = &handlerOf(batchRest.front());
+				batchPart.clear();
+				size_t kept = 0;
+				for (size_t k = 0; k < batchRest.size(); ++k)
+				{
+					if (&handlerOf(batchRest[k]) == handler)
+						batchPart.push_back(batchRest[k]);
+					else
+						batchRest[kept++] = batchRest[k];
+				}
+				batchRest.resize(kept);
+				handler->PostBatch(listener, batchPart);
+			}
+		}
+#ifdef TANMI_METRICS
+		/**
+		 * @brief 记录一次通过预处理的触发，需持有mtx
+		 */
+		void recordTrigger(EventID id, size_t listeners)
+		{
+			auto& metric = eventMetrics[id];
+			metric.id = id;
+			metric.fired++;
+			metric.listeners += listeners;
+			metricPosted.Add(listeners);
+		}
+		/**
+		 * @brief 记录一条批量消息，需持有mtx
+		 */
+		void recordBatch(std::span<const EventID> events)
+		{
+			for (auto id : events)
+				eventMetrics[id].listeners++;
+			metricPosted.Add();
+		}
+#endif // TANMI_METRICS
 	public:
-		static EventSystem& Instance();								//< ȡEventSystemʵ
+		static EventSystem& Instance();								//< 获取EventSystem实例引用
 
 		/**
-		 * @brief עϢ
+		 * @brief 注册消息处理器
 		 * 
-		 * @param _messageHandler Ϣ
+		 * @param _messageHandler 消息处理器
+		 * @param _startThread 是否启动处理线程，为false时需由调用者通过 MessageHandler::Poll 处理消息
 		 */
-		void RegisterMessageHandler(std::shared_ptr<MessageHandler> _messageHandler);
+		void RegisterMessageHandler(std::shared_ptr<MessageHandler> _messageHandler, bool _startThread = true);
 
 		/**
-		 * @brief עᲢϢ
+		 * @brief 注册并返回消息处理器
 		 * 
-		 * @tparam T Ϣ
-		 * @param pram Ϣ
+		 * @tparam T 消息处理器类型
+		 * @param pram 消息处理器构造参数
 		 * 
-		 * @return Ϣָ
+		 * @return 消息处理器指针
 		 */
 		template<MessageHandlerBase T, typename... P>
 		std::shared_ptr<T> RegisterMessageHandler(P...pram);
 
 		/**
-		 * @brief עϢʱ
+		 * @brief 注册消息处理器（带有时间参数）
 		 * 
-		 * @param _messageHandlerUpdate Ϣʱ
+		 * @param _messageHandlerUpdate 消息处理器（带有时间参数）
+		 * @param _startThread 是否启动处理线程，为false时需由调用者通过 MessageHandlerUpdate::Poll 处理消息
 		 */
-		void RegisterMessageHandlerUpdate(std::shared_ptr<MessageHandlerUpdate> _messageHandlerUpdate);
+		void RegisterMessageHandlerUpdate(std::shared_ptr<MessageHandlerUpdate> _messageHandlerUpdate, bool _startThread = true);
 
 		/**
-		 * @brief עᲢϢʱ
+		 * @brief 注册并返回消息处理器（带有时间参数）
 		 * 
-		 * @tparam T Ϣ
-		 * @param pram Ϣ
+		 * @tparam T 消息处理器类型
+		 * @param pram 消息处理器构造参数
 		 * 
-		 * @return std::shared_ptr<T> Ϣָ
+		 * @return std::shared_ptr<T> 消息处理器指针
 		 */
 		template<MessageHandlerUpdateBase T, typename... P>
 		std::shared_ptr<T> RegisterMessageHandlerUpdate(P...pram);
 
 		/**
-		 * @brief ʹĬϢ
+		 * @brief 使用默认消息处理器
 		 */
 		void UseMessageHandlerDefault();
 
 		/**
-		 * @brief ע¼
+		 * @brief 获取当前消息处理器
+		 * 
+		 * @return std::shared_ptr<MessageHandler> 消息处理器，未注册时为空
+		 */
+		std::shared_ptr<MessageHandler> GetMessageHandler() const;
+
+		/**
+		 * @brief 获取当前消息处理器（带有时间参数）
+		 * 
+		 * @return std::shared_ptr<MessageHandlerUpdate> 消息处理器，未注册时为空
+		 */
+		std::shared_ptr<MessageHandlerUpdate> GetMessageHandlerUpdate() const;
+
+		/**
+		 * @brief 注册具名处理管线的消息处理器，路由至该管线的事件由其处理
+		 * 
+		 * 同名管线已有处理器时与 RegisterMessageHandler 相同，旧处理器退出后其积压的消息迁移至新处理器
+		 * @param name 管线名称
+		 * @param _messageHandler 消息处理器，可独立设置启动配置与等待策略；为空时管线改用默认处理器，旧处理器积压的消息迁移至默认处理器
+		 * @param _startThread 是否启动处理线程，为false时需由调用者通过 MessageHandler::Poll 处理消息
+		 */
+		void RegisterRouteHandler(std::string_view name, std::shared_ptr<MessageHandler> _messageHandler, bool _startThread = true);
+
+		/**
+		 * @brief 注册具名处理管线的消息处理器（带有时间参数）
+		 * 
+		 * @param name 管线名称
+		 * @param _messageHandlerUpdate 消息处理器（带有时间参数），为空时管线改用默认处理器
+		 * @param _startThread 是否启动处理线程，为false时需由调用者通过 MessageHandlerUpdate::Poll 处理消息
+		 */
+		void RegisterRouteHandlerUpdate(std::string_view name, std::shared_ptr<MessageHandlerUpdate> _messageHandlerUpdate, bool _startThread = true);
+
+		/**
+		 * @brief 获取具名处理管线的消息处理器
+		 * 
+		 * @param name 管线名称
+		 * @return std::shared_ptr<MessageHandler> 消息处理器，未注册时为空
+		 */
+		std::shared_ptr<MessageHandler> GetRouteHandler(std::string_view name);
+
+		/**
+		 * @brief 获取具名处理管线的消息处理器（带有时间参数）
 		 * 
-		 * @param event ¼
+		 * @param name 管线名称
+		 * @return std::shared_ptr<MessageHandlerUpdate> 消息处理器，未注册时为空
+		 */
+		std::shared_ptr<MessageHandlerUpdate> GetRouteHandlerUpdate(std::string_view name);
+
+		/**
+		 * @brief 获取事件路由至的消息处理器（带有时间参数），即 TriggerEventUpdate 发送该事件的处理器
+		 * 
+		 * @param eventID 事件ID
+		 * @return std::shared_ptr<MessageHandlerUpdate> 管线的处理器，管线未注册处理器时为默认处理器
+		 */
+		std::shared_ptr<MessageHandlerUpdate> GetEventHandlerUpdate(const EventID eventID);
+
+		/**
+		 * @brief 将事件路由至具名处理管线，此后该事件的消息发送至管线的处理器
+		 * 
+		 * 管线可在注册处理器之前指定，未注册处理器的管线使用默认处理器；已发送的消息仍由原处理器处理，因此切换前后的消息不保证顺序
+		 * @param event 事件
+		 * @param name 管线名称，为空时恢复使用默认处理器
+		 */
+		void RouteEvent(const Event& event, std::string_view name);
+
+		/**
+		 * @brief 将事件路由至具名处理管线
+		 * 
+		 * @param eventID 事件ID，可为已注册事件或静态事件的ID
+		 * @param name 管线名称，为空时恢复使用默认处理器
+		 */
+		void RouteEvent(const EventID eventID, std::string_view name);
+
+		/**
+		 * @brief 将容器中的事件路由至具名处理管线
+		 * 
+		 * @tparam T 事件容器类型
+		 * @param events 事件容器
+		 * @param name 管线名称，为空时恢复使用默认处理器
+		 */
+		template<EventContainer T>
+		void RouteEvents(const T& events, std::string_view name);
+
+		/**
+		 * @brief 将匹配主题模式的事件组路由至具名处理管线
+		 * 
+		 * 已注册的匹配事件立即路由，此后以匹配主题注册的事件在注册时路由；多个模式匹配同一主题时以后指定的为准，
+		 * 再次指定同一模式时替换其原有路由并视为最后指定
+		 * @param pattern 主题模式，支持通配符'+'与'#'
+		 * @param name 管线名称，为空时恢复使用默认处理器
+		 * @return size_t 当前路由的事件数量
+		 */
+		size_t RouteTopic(const std::string& pattern, std::string_view name);
+
+		/**
+		 * @brief 获取事件路由至的管线名称
+		 * 
+		 * @param eventID 事件ID
+		 * @return std::string 管线名称，使用默认处理器时为空
+		 */
+		std::string GetEventRoute(const EventID eventID);
+
+		/**
+		 * @brief 注册事件
+		 * 
+		 * @param event 事件
 		 */
 		void RegisterEvent(Event& event);
 
 		/**
-		 * @brief ʹע¼
+		 * @brief 使用容器注册事件
 		 * 
-		 * @tparam T ¼
-		 * @param events ¼
+		 * @tparam T 事件容器类型
+		 * @param events 事件容器
 		 */
 		template<EventContainer T>
 		void RegisterEvent(T& events);
 
 		/**
-		 * @brief ½ע¼
+		 * @brief 新建并注册事件
 		 * 
-		 * @tparam T ¼
-		 * @return std::shared_ptr<T> ¼ָ
+		 * @tparam T 事件类型
+		 * @return std::shared_ptr<T> 事件指针
 		 */
 		template<EventBase T>
 		std::shared_ptr<T> NewAndRegisterEvent();
 
 		/**
-		 * @brief ½עָ¼
+		 * @brief 以主题注册事件，已订阅匹配主题模式的监听器自动绑定至该事件
+		 * 
+		 * @param event 事件
+		 * @param topic 以'/'分隔层级的主题，如"combat/damage/fire"
+		 */
+		void RegisterEvent(Event& event, const std::string& topic);
+
+		/**
+		 * @brief 新建并以主题注册事件
+		 * 
+		 * @tparam T 事件类型
+		 * @param topic 以'/'分隔层级的主题
+		 * @return std::shared_ptr<T> 事件指针
+		 */
+		template<EventBase T>
+		std::shared_ptr<T> NewAndRegisterEvent(const std::string& topic);
+
+		/**
+		 * @brief 获取主题对应的事件ID
+		 * 
+		 * @param topic 主题
+		 * @return EventID 事件ID，主题未注册时为0
+		 */
+		EventID GetTopicEvent(std::string_view topic);
+
+		/**
+		 * @brief 获取匹配主题模式的所有事件ID
+		 * 
+		 * @param pattern 主题模式
+		 * @return std::vector<EventID> 事件ID列表
+		 */
+		std::vector<EventID> MatchTopic(std::string_view pattern);
+
+		/**
+		 * @brief 判断主题是否匹配主题模式
 		 * 
-		 * @tparam T ¼
-		 * @param num ¼
+		 * 模式中'+'匹配单个层级，位于末尾的'#'匹配零或多个层级，如"combat/#"匹配"combat"及其下所有主题
+		 * @param pattern 主题模式
+		 * @param topic 主题
+		 * @return true 匹配
+		 * @return false 不匹配
+		 */
+		static bool IsTopicMatch(std::string_view pattern, std::string_view topic);
+
+		/**
+		 * @brief 新建并注册指定数量事件
 		 * 
-		 * @return std::vector<std::shared_ptr<T>> ¼ָб
+		 * @tparam T 事件类型
+		 * @param num 事件数量
+		 * 
+		 * @return std::vector<std::shared_ptr<T>> 事件指针列表
 		 */
 		template<EventBase T>
 		inline std::vector<std::shared_ptr<T>> NewAndRegisterEvents(int num);
 
 		/**
-		 * @brief ½עָ¼
+		 * @brief 新建并注册指定类型数量事件
 		 * 
-		 * @tparam T ¼
-		 * @tparam C ¼
+		 * @tparam T 事件类型
+		 * @tparam C 事件容器类型
 		 * 
-		 * @param num ¼
+		 * @param num 事件数量
 		 * 
-		 * @return C ¼
+		 * @return C 事件容器
 		 */
 		template<EventBase T, InputRangeContainer C>
 		C NewAndRegisterEvents(int num);
 
 		/**
-		 * @brief ¼
+		 * @brief 触发事件
 		 * 
-		 * @param event ¼
+		 * @param event 事件
 		 */
 		void TriggerEvent(const Event& event);
 
 		/**
-		 * @brief ¼
+		 * @brief 触发事件
 		 * 
-		 * @param eventID ¼ID
+		 * @param eventID 事件ID
 		 */
 		void TriggerEvent(const EventID eventID);
 
 		/**
-		 * @brief ¼
+		 * @brief 触发事件
 		 * 
-		 * @param event ¼
-		 * @param ms ¼ʱĸ¼
+		 * @param event 事件
+		 * @param ms 事件触发时的更新间隔
 		 */
 		void TriggerEventUpdate(const Event& event, double ms);
 
 		/**
-		 * @brief ¼
+		 * @brief 触发事件
 		 * 
-		 * @param eventID ¼ID
-		 * @param ms ¼ʱĸ¼
+		 * @param eventID 事件ID
+		 * @param ms 事件触发时的更新间隔
 		 */
 		void TriggerEventUpdate(const EventID eventID, double ms);
 
 		/**
-		 * @brief ¼
+		 * @brief 批量触发事件，每个监听器以一次 WakeEventBatch 接收其订阅的所有事件
+		 * 
+		 * 同一事件在列表中重复出现、监听器重复绑定时只通知一次；没有监听器的事件被忽略
+		 * @param events 事件ID列表
+		 */
+		void TriggerEvents(std::span<const EventID> events);
+
+		/**
+		 * @brief 设置批量触发是否使用订阅位矩阵
+		 * 
+		 * 开启后批量触发以位运算求订阅者并集，适用于多个事件共享大量监听器的场景；矩阵在事件列表变化后的下一次批量触发时重建
+		 * @param enable 是否使用
+		 */
+		void SetSubscriptionMatrix(bool enable);
+
+		/**
+		 * @brief 设置内部容器使用的内存资源，已有的订阅与事件迁移至新资源
+		 *
+		 * 配合 EventPoolResource 与以同一资源构造的消息处理器，稳定运行后触发与分发不再调用全局分配器；
+		 * 资源的生命周期须长于事件系统，或在销毁资源前以 nullptr 恢复默认资源。不可与 RegisterEvent 并发调用
+		 * @param resource 内存资源，为 nullptr 时使用默认资源
+		 */
+		void SetMemoryResource(std::pmr::memory_resource* resource);
+		/**
+		 * @brief 获取内部容器使用的内存资源
+		 */
+		std::pmr::memory_resource* GetMemoryResource() const;
+
+		/**
+		 * @brief 触发事件并追踪其处理进度
+		 * 
+		 * @param event 事件
+		 * @return TriggerHandle 触发句柄，所有监听器处理完毕后完成
+		 */
+		TriggerHandle TriggerEventTracked(const Event& event);
+
+		/**
+		 * @brief 触发事件并追踪其处理进度
+		 * 
+		 * @param eventID 事件ID
+		 * @return TriggerHandle 触发句柄，所有监听器处理完毕后完成
+		 */
+		TriggerHandle TriggerEventTracked(const EventID eventID);
+
+		/**
+		 * @brief 触发事件并追踪其处理进度
 		 * 
-		 * @param event ¼
-		 * @param client 
+		 * @param event 事件
+		 * @param ms 事件触发时的更新间隔
+		 * @return TriggerHandle 触发句柄，所有监听器处理完毕后完成
+		 */
+		TriggerHandle TriggerEventUpdateTracked(const Event& event, double ms);
+
+		/**
+		 * @brief 触发事件并追踪其处理进度
+		 * 
+		 * @param eventID 事件ID
+		 * @param ms 事件触发时的更新间隔
+		 * @return TriggerHandle 触发句柄，所有监听器处理完毕后完成
+		 */
+		TriggerHandle TriggerEventUpdateTracked(const EventID eventID, double ms);
+
+		/**
+		 * @brief 添加事件
+		 * 
+		 * @param event 事件名称
+		 * @param client 监听对象
 		 */
 		void AddEventHandler(const Event& event, std::shared_ptr<Listener> client);
+
+		/**
+		 * @brief 订阅主题模式
+		 * 
+		 * 订阅时即绑定至所有匹配的已注册事件，此后以匹配主题注册的事件也会自动绑定，触发开销与直接绑定相同
+		 * @param pattern 主题模式，支持通配符'+'与'#'
+		 * @param client 监听对象
+		 * @return size_t 当前绑定的事件数量
+		 */
+		size_t AddTopicHandler(const std::string& pattern, std::shared_ptr<Listener> client);
+
+		/**
+		 * @brief 取消订阅主题模式，并解除由该订阅产生的绑定
+		 * 
+		 * @param pattern 主题模式
+		 * @param client 监听对象
+		 */
+		void RemoveTopicHandler(const std::string& pattern, std::shared_ptr<Listener> client);
 		
 		/**
-		 * @brief ¼
+		 * @brief 添加事件
 		 * 
-		 * @tparam T ¼
+		 * @tparam T 事件容器类型
 		 * 
-		 * @param events ¼
-		 * @param client 
+		 * @param events 事件名称容器
+		 * @param client 监听对象
 		 */
 		template<EventContainer T>
 		void AddEventHandler(const T& events, std::shared_ptr<Listener> client);
 
 		/**
-		 * @brief ¼
+		 * @brief 添加事件
 		 * 
-		 * @tparam T 
-		 * @param event ¼
-		 * @param clients 
+		 * @tparam T 监听对象容器类型
+		 * @param event 事件名称
+		 * @param clients 监听对象容器
 		 */
 		template<ListenerSptrContainer T>
 		void addEventHandler(const Event& event, const T& clients);
 
 		/**
-		 * @brief Ƴ¼ض
+		 * @brief 移除事件下特定监听
 		 * 
-		 * @param event ¼
-		 * @param client Ƴļ
+		 * @param event 事件名称
+		 * @param client 待移除的监听对象
 		 */
 		void RemoveEventHandler(const Event& event, std::shared_ptr<Listener> client);
 
 		/**
-		 * @brief Ƴָ¼µм
+		 * @brief 移除事件下特定监听，无异常输出
 		 * 
-		 * @param event ¼
+		 * @param eventID 事件ID
+		 * @param client 待移除的监听对象
+		 * @return true 移除成功
+		 * @return false 未找到该监听
+		 */
+		bool RemoveEventHandlerNoException(const EventID eventID, std::shared_ptr<Listener> client);
+
+		/**
+		 * @brief 移除指定事件名称下的所有监听
+		 * 
+		 * @param event 事件名称
 		 */
 		void RemoveAllEventForEventName(const Event& event);
 
 		/**
-		 * @brief Ƴָص¼
+		 * @brief 移除所有与指定监听对象相关的事件
 		 * 
-		 * @param client Ƴļ
+		 * @param client 待移除的监听对象
 		 */
 		void RemoveAllEventForListener(const std::shared_ptr<Listener> client);
 
 		/**
-		 * @brief жָ¼Ƿ
+		 * @brief 判断指定事件是否存在
 		 * 
-		 * @param event ¼
-		 * @return  true 
-		 * @return  false 
+		 * @param event 事件名称
+		 * @return  true 存在
+		 * @return  false 不存在
 		 */
 		bool IsEventExist(const Event& event)const;
 
 		/**
-		 * @brief жָ¼Ƿڣ쳣
+		 * @brief 判断指定事件是否存在，无异常检测
 		 * 
-		 * @param event ¼
-		 * @return true 
-		 * @return false 
+		 * @param event 事件名称
+		 * @return true 存在
+		 * @return false 不存在
 		 */
 		bool IsEventExistNoException(const Event& event)const;
 
 		/**
-		 * @brief 
+		 * @brief 等待指定事件中任一事件的下一次触发（需包含TanmiCoroutine.hpp）
+		 * 
+		 * @param event 事件对象
+		 * @param events 其余事件对象
+		 * @return EventAwaiter 可供co_await的等待对象
+		 */
+		template<typename... Events>
+		static EventAwaiter Next(const Event& event, const Events&... events);
+
+		/**
+		 * @brief 获取运行指标快照，包含默认与各具名管线消息处理器的指标（需定义 TANMI_METRICS，否则为空快照）
+		 * 
+		 * @return EventSystemMetricsSnapshot 指标快照
+		 */
+		EventSystemMetricsSnapshot GetMetrics();
+
+		/**
+		 * @brief 清空运行指标，包含默认与各具名管线消息处理器的指标
+		 */
+		void ResetMetrics();
+
+		/**
+		 * @brief 析构函数
 		 */
 		~EventSystem();
 	};
 
-	EventSystem& TanmiEngine::EventSystem::Instance()
+	EventSystem& TanmiEngine::EventSystem::Instance()
+	{
+		static EventSystem instance;
+		return instance;
+	}
+
+	inline void EventSystem::RegisterMessageHandler(std::shared_ptr<MessageHandler> _messageHandler, bool _startThread)
+	{
+		std::shared_ptr<MessageHandler> old;
+		{
+			// 此后的触发均发送至新处理器
+			std::lock_guard<std::mutex> lock(mtx);
+			if (isMessageHandlerRegisted && messageHandler != _messageHandler)
+				old = messageHandler;
+			messageHandler = _messageHandler;
+			isMessageHandlerRegisted = true;
+		}
+		if (old)
+		{
+			// 等待旧处理线程处理完当前消息后退出，其积压的消息排在新处理器已有消息之前
+			old->Exit();
+			old->Join();
+			old->MigrateTo(*_messageHandler);
+		}
+		if (_startThread)
+			_messageHandler->Start();
+	}
+
+	inline void EventSystem::RegisterMessageHandlerUpdate(std::shared_ptr<MessageHandlerUpdate> _messageHandlerUpdate, bool _startThread)
+	{
+		std::shared_ptr<MessageHandlerUpdate> old;
+		{
+			// 此后的触发均发送至新处理器
+			std::lock_guard<std::mutex> lock(mtx);
+			if (isMessageHandlerUpdateRegisted && messageHandlerUpdate != _messageHandlerUpdate)
+				old = messageHandlerUpdate;
+			messageHandlerUpdate = _messageHandlerUpdate;
+			isMessageHandlerUpdateRegisted = true;
+		}
+		if (old)
+		{
+			// 等待旧处理线程处理完当前消息后退出，其积压的消息排在新处理器已有消息之前
+			old->Exit();
+			old->Join();
+			old->MigrateTo(*_messageHandlerUpdate);
+		}
+		if (_startThread)
+			_messageHandlerUpdate->Start();
+	}
+
+	inline void EventSystem::UseMessageHandlerDefault()
+	{
+		auto messageHandler = RegisterMessageHandler<MessageHandler>();
+		auto messageHandlerUpdate = RegisterMessageHandlerUpdate<MessageHandlerUpdate>();
+	}
+
+	inline std::shared_ptr<MessageHandler> EventSystem::GetMessageHandler() const
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		return messageHandler;
+	}
+
+	inline std::shared_ptr<MessageHandlerUpdate> EventSystem::GetMessageHandlerUpdate() const
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		return messageHandlerUpdate;
+	}
+
+	inline void EventSystem::RegisterRouteHandler(std::string_view name, std::shared_ptr<MessageHandler> _messageHandler, bool _startThread)
+	{
+		std::shared_ptr<MessageHandler> old;
+		std::shared_ptr<MessageHandler> target;
+		try
+		{
+			// 此后路由至该管线的触发均发送至新处理器，为空时发送至默认处理器
+			std::lock_guard<std::mutex> lock(mtx);
+			auto& route = routes[routeOf(name)];
+			if (route.handler != _messageHandler)
+				old = route.handler;
+			route.handler = _messageHandler;
+			target = _messageHandler ? _messageHandler : messageHandler;
+		}
+		catch (EventSystemException& e)
+		{
+			std::cout << "::EventSystem::RegisterRouteHandler()" << e.what() << std::endl;
+			return;
+		}
+		// 管线原处理器即为默认处理器时继续使用，不退出
+		if (old && old != target)
+		{
+			old->Exit();
+			old->Join();
+			if (target)
+				old->MigrateTo(*target);
+		}
+		if (_startThread && _messageHandler)
+			_messageHandler->Start();
+	}
+
+	inline void EventSystem::RegisterRouteHandlerUpdate(std::string_view name, std::shared_ptr<MessageHandlerUpdate> _messageHandlerUpdate, bool _startThread)
+	{
+		std::shared_ptr<MessageHandlerUpdate> old;
+		std::shared_ptr<MessageHandlerUpdate> target;
+		try
+		{
+			// 此后路由至该管线的触发均发送至新处理器，为空时发送至默认处理器
+			std::lock_guard<std::mutex> lock(mtx);
+			auto& route = routes[routeOf(name)];
+			if (route.handlerUpdate != _messageHandlerUpdate)
+				old = route.handlerUpdate;
+			route.handlerUpdate = _messageHandlerUpdate;
+			target = _messageHandlerUpdate ? _messageHandlerUpdate : messageHandlerUpdate;
+		}
+		catch (EventSystemException& e)
+		{
+			std::cout << "::EventSystem::RegisterRouteHandlerUpdate()" << e.what() << std::endl;
+			return;
+		}
+		// 管线原处理器即为默认处理器时继续使用，不退出
+		if (old && old != target)
+		{
+			old->Exit();
+			old->Join();
+			if (target)
+				old->MigrateTo(*target);
+		}
+		if (_startThread && _messageHandlerUpdate)
+			_messageHandlerUpdate->Start();
+	}
+
+	inline std::shared_ptr<MessageHandler> EventSystem::GetRouteHandler(std::string_view name)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		for (size_t i = 1; i < routes.size(); ++i)
+		{
+			if (routes[i].name == name)
+				return routes[i].handler;
+		}
+		return nullptr;
+	}
+
+	inline std::shared_ptr<MessageHandlerUpdate> EventSystem::GetRouteHandlerUpdate(std::string_view name)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		for (size_t i = 1; i < routes.size(); ++i)
+		{
+			if (routes[i].name == name)
+				return routes[i].handlerUpdate;
+		}
+		return nullptr;
+	}
+
+	inline std::shared_ptr<MessageHandlerUpdate> EventSystem::GetEventHandlerUpdate(const EventID eventID)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		auto& route = routes[routeIndexOf(eventID)];
+		return route.handlerUpdate ? route.handlerUpdate : messageHandlerUpdate;
+	}
+
+	inline void EventSystem::RouteEvent(const Event& event, std::string_view name)
 	{
-		static EventSystem instance;
-		return instance;
+		RouteEvent(event.ID, name);
 	}
 
-	inline void EventSystem::RegisterMessageHandler(std::shared_ptr<MessageHandler> _messageHandler)
+	inline void EventSystem::RouteEvent(const EventID eventID, std::string_view name)
 	{
-		if (isMessageHandlerRegisted)
-			messageHandler->Exit();
-		messageHandler = _messageHandler;
-		std::thread thread(&MessageHandler::Run, _messageHandler.get());
-		thread.detach();
-		isMessageHandlerRegisted = true;
+		try
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			if (eventID <= 0 || (IsStaticEvent(eventID) == false && (size_t)eventID >= eventsPreprocess.size()))
+			{
+				throw EventSystemEventNotRegistedException();
+			}
+			setRoute(eventID, name.empty() ? 0 : routeOf(name));
+		}
+		catch (EventSystemException& e)
+		{
+			std::cout << "::EventSystem::RouteEvent()" << e.what() << std::endl;
+		}
 	}
 
-	inline void EventSystem::RegisterMessageHandlerUpdate(std::shared_ptr<MessageHandlerUpdate> _messageHandlerUpdate)
+	template<EventContainer T>
+	inline void EventSystem::RouteEvents(const T& events, std::string_view name)
 	{
-		if (isMessageHandlerUpdateRegisted)
-			messageHandlerUpdate->Exit();
-		messageHandlerUpdate = _messageHandlerUpdate;
-		std::thread thread(&MessageHandlerUpdate::Run, _messageHandlerUpdate.get());
-		thread.detach();
-		isMessageHandlerUpdateRegisted = true;
+		for (auto& event : events)
+		{
+			RouteEvent(event.ID, name);
+		}
 	}
 
-	inline void EventSystem::UseMessageHandlerDefault()
+	inline size_t EventSystem::RouteTopic(const std::string& pattern, std::string_view name)
 	{
-		auto messageHandler = RegisterMessageHandler<MessageHandler>();
-		auto messageHandlerUpdate = RegisterMessageHandlerUpdate<MessageHandlerUpdate>();
+		try
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			uint16_t route = name.empty() ? 0 : routeOf(name);
+			// 同一模式只保留最后一次指定
+			std::erase_if(topicRoutes, [&](const auto& topicRoute) { return topicRoute.first == pattern; });
+			topicRoutes.emplace_back(pattern, route);
+			size_t count = 0;
+			for (auto& topic : topics)
+			{
+				if (IsTopicMatch(pattern, topic.first))
+				{
+					setRoute(topic.second, route);
+					++count;
+				}
+			}
+			return count;
+		}
+		catch (EventSystemException& e)
+		{
+			std::cout << "::EventSystem::RouteTopic()" << e.what() << std::endl;
+		}
+		return 0;
+	}
+
+	inline std::string EventSystem::GetEventRoute(const EventID eventID)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		return routes[routeIndexOf(eventID)].name;
 	}
 
 	template<EventBase T>
@@ -410,11 +1085,89 @@ namespace TanmiEngine
 	inline void EventSystem::RegisterEvent(Event& event)
 	{
 		static int eventID = 1;
-		auto f = std::bind(&Event::preProcess, event);
-		eventsPreprocess.push_back(f);
+		eventsPreprocess.push_back(event);
 		event.ID = eventID++;
 	}
 
+	inline void EventSystem::RegisterEvent(Event& event, const std::string& topic)
+	{
+		RegisterEvent(event);
+		std::lock_guard<std::mutex> lock(mtx);
+		topics[topic] = event.ID;
+		// 应用匹配的主题路由，后指定的优先
+		for (auto& topicRoute : topicRoutes)
+		{
+			if (IsTopicMatch(topicRoute.first, topic))
+				setRoute(event.ID, topicRoute.second);
+		}
+		// 将已有的主题订阅展开至新事件
+		for (auto it = topicHandlers.begin(); it != topicHandlers.end();)
+		{
+			auto client = it->second.lock();
+			if (client == nullptr)
+			{
+				it = topicHandlers.erase(it);
+				continue;
+			}
+			if (IsTopicMatch(it->first, topic))
+			{
+				EventList.insert(std::make_pair(event.ID, it->second));
+				matrixDirty = true;
+			}
+			++it;
+		}
+	}
+
+	template<EventBase T>
+	std::shared_ptr<T> EventSystem::NewAndRegisterEvent(const std::string& topic)
+	{
+		std::shared_ptr<T> event = std::make_shared<T>();
+		RegisterEvent(*event, topic);
+		return event;
+	}
+
+	inline EventID EventSystem::GetTopicEvent(std::string_view topic)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		auto it = topics.find(topic);
+		return it == topics.end() ? 0 : it->second;
+	}
+
+	inline std::vector<EventID> EventSystem::MatchTopic(std::string_view pattern)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		std::vector<EventID> result;
+		for (auto& topic : topics)
+		{
+			if (IsTopicMatch(pattern, topic.first))
+				result.push_back(topic.second);
+		}
+		return result;
+	}
+
+	inline bool EventSystem::IsTopicMatch(std::string_view pattern, std::string_view topic)
+	{
+		while (true)
+		{
+			auto p_end = pattern.find('/');
+			auto p_level = pattern.substr(0, p_end);
+			if (p_level == "#")
+				return true;
+			auto t_end = topic.find('/');
+			auto t_level = topic.substr(0, t_end);
+			if (p_level != "+" && p_level != t_level)
+				return false;
+			// 模式已结束
+			if (p_end == std::string_view::npos)
+				return t_end == std::string_view::npos;
+			// 主题已结束，仅剩"/#"时匹配
+			if (t_end == std::string_view::npos)
+				return pattern.substr(p_end + 1) == "#";
+			pattern.remove_prefix(p_end + 1);
+			topic.remove_prefix(t_end + 1);
+		}
+	}
+
 	template<EventContainer T>
 	inline void EventSystem::RegisterEvent(T& events)
 	{
@@ -426,40 +1179,29 @@ namespace TanmiEngine
 
 	inline void EventSystem::TriggerEvent(const Event& event)
 	{
+		TriggerEvent(event.ID);
+	}
+
+	inline void EventSystem::TriggerEvent(const EventID eventID)
+	{
+		TANMI_TRACE_POINT(TraceScope trace_scope(TraceType::TriggerBegin, TraceType::TriggerEnd, eventID));
+		TANMI_JOURNAL_POINT(EventJournal::Record(eventID));
 		try
 		{
-			// Ѱ¼
-			auto range = EventList.equal_range(event.ID);
-			if (std::distance(range.first, range.second) == 0)
-			{
-				throw EventSystemEventNotFoundException();
-			}
-			// Ԥ
-			if (eventsPreprocess[event.ID]() == false)
-				return;
-			// λ
-			auto& it = range.first;
-			auto& it_end = range.second;
+			std::lock_guard<std::mutex> lock_list(mtx);
 			std::lock_guard<std::mutex> lock(mtx_temp);
-			// ѹ
-			while (it != it_end)
-			{
-				if (!it->second.expired())
-				{
-					listenersToWake.push_back(it->second.lock());
-					it++;
-				}
-				else
-				{
-					EventList.erase(it++);
-				}
-			}
-			// ֪ͨ
+			TANMI_METRIC(metricTriggers.Add());
+			// 寻找事件、预处理并压缓冲
+			if (collectListeners(eventID) == false)
+				return;
+			TANMI_METRIC(recordTrigger(eventID, listenersToWake.size()));
+			// 通知
+			auto& handler = handlerOf(eventID);
 			for (auto& listener : listenersToWake)
 			{
-				messageHandler->Post(event.ID, listener);
+				handler.Post(eventID, listener);
 			}
-			// ջ
+			// 清空缓冲
 			listenersToWake.clear();
 		}
 		catch (EventSystemException& e)
@@ -468,136 +1210,253 @@ namespace TanmiEngine
 		}
 	}
 
-	inline void EventSystem::TriggerEvent(const EventID eventID)
+	inline void EventSystem::TriggerEventUpdate(const Event& event, double ms)
+	{
+		TriggerEventUpdate(event.ID, ms);
+	}
+
+	inline void EventSystem::TriggerEventUpdate(const EventID eventID, double ms)
 	{
+		TANMI_TRACE_POINT(TraceScope trace_scope(TraceType::TriggerBegin, TraceType::TriggerEnd, eventID));
+		TANMI_JOURNAL_POINT(EventJournal::Record(eventID, ms, true));
 		try
 		{
-			// Ѱ¼
-			auto range = EventList.equal_range(eventID);
-			if (std::distance(range.first, range.second) == 0)
-			{
-				throw EventSystemEventNotFoundException();
-			}
-			// Ԥ
-			if (eventsPreprocess[eventID]() == false)
-				return;
-			// λ
-			auto& it = range.first;
-			auto& it_end = range.second;
+			std::lock_guard<std::mutex> lock_list(mtx);
 			std::lock_guard<std::mutex> lock(mtx_temp);
-			// ѹ
-			while (it != it_end)
-			{
-				if (!it->second.expired())
-				{
-					listenersToWake.push_back(it->second.lock());
-					it++;
-				}
-				else
-				{
-					EventList.erase(it++);
-				}
-			}
-			// ֪ͨ
+			TANMI_METRIC(metricTriggers.Add());
+			// 寻找事件、预处理并压缓冲
+			if (collectListeners(eventID) == false)
+				return;
+			TANMI_METRIC(recordTrigger(eventID, listenersToWake.size()));
+			// 通知
+			auto& handler = handlerUpdateOf(eventID);
 			for (auto& listener : listenersToWake)
 			{
-				messageHandler->Post(eventID, listener);
+				handler.Post(eventID, listener, ms);
 			}
-			// ջ
+			// 清空缓冲
 			listenersToWake.clear();
 		}
 		catch (EventSystemException& e)
 		{
-			std::cout << "::EventSystem::WakeEvent()" << e.what() << std::endl;
+			std::cout << "::EventSystem::TriggerEventUpdate()" << e.what() << std::endl;
 		}
 	}
 
-	inline void EventSystem::TriggerEventUpdate(const Event& event, double ms)
+	inline void EventSystem::TriggerEvents(std::span<const EventID> events)
 	{
+		TANMI_TRACE_POINT(TraceScope trace_scope(TraceType::TriggerBegin, TraceType::TriggerEnd, 0));
+		TANMI_JOURNAL_POINT(for (auto id : events)
+			EventJournal::Record(id));
 		try
 		{
-			// Ѱ¼
-			auto range = EventList.equal_range(event.ID);
-			if (std::distance(range.first, range.second) == 0)
+			std::lock_guard<std::mutex> lock_list(mtx);
+			std::lock_guard<std::mutex> lock(mtx_temp);
+			TANMI_METRIC(metricTriggers.Add());
+			batchEvents.clear();
+			if (useMatrix)
 			{
-				throw EventSystemEventNotFoundException();
-			}
-			// Ԥ
-			if (eventsPreprocess[event.ID]() == false)
+				if (matrixDirty)
+				{
+					matrix.Rebuild(EventList);
+					matrixDirty = false;
+				}
+				size_t stride = matrix.Stride();
+				matrixAcc.assign(stride, 0);
+				matrixRows.clear();
+				// 求订阅者并集
+				for (auto id : events)
+				{
+					const uint64_t* row = matrix.Row(id);
+					if (row == nullptr || std::find(batchEvents.begin(), batchEvents.end(), id) != batchEvents.end())
+						continue;
+					if (preProcess(id) == false)
+					{
+						TANMI_METRIC(metricSuppressed.Add());
+						continue;
+					}
+					TANMI_METRIC(recordTrigger(id, 0));
+					matrix.Accumulate(matrixAcc.data(), row);
+					matrixRows.push_back(row);
+					batchEvents.push_back(id);
+				}
+				// 通知
+				for (size_t w = 0; w < stride; ++w)
+				{
+					for (uint64_t word = matrixAcc[w]; word != 0; word &= word - 1)
+					{
+						size_t slot = w * 64 + std::countr_zero(word);
+						auto listener = matrix.GetListener(slot);
+						if (listener == nullptr)
+						{
+							matrixDirty = true;
+							continue;
+						}
+						batchSubset.clear();
+						for (size_t k = 0; k < batchEvents.size(); ++k)
+						{
+							if (SubscriptionMatrix::Test(matrixRows[k], slot))
+								batchSubset.push_back(batchEvents[k]);
+						}
+						TANMI_METRIC(recordBatch(batchSubset));
+						postBatch(listener, batchSubset);
+					}
+				}
 				return;
-			// λ
-			auto& it = range.first;
-			auto& it_end = range.second;
-			std::lock_guard<std::mutex> lock(mtx_temp);
-			// ѹ
-			while (it != it_end)
+			}
+			// 压缓冲
+			for (auto id : events)
 			{
-				if (!it->second.expired())
+				if (std::find(batchEvents.begin(), batchEvents.end(), id) != batchEvents.end())
+					continue;
+				// 没有监听器的事件被忽略
+				if (EventList.contains(id) == false || collectListeners(id) == false)
+					continue;
+				TANMI_METRIC(recordTrigger(id, 0));
+				batchEvents.push_back(id);
+				for (auto& listener : listenersToWake)
+					batchTargets.emplace_back(std::move(listener), batchEvents.size() - 1);
+				listenersToWake.clear();
+			}
+			// 按监听器分组，组内按事件下标排序以保持事件顺序；std::sort 不申请临时缓冲
+			std::sort(batchTargets.begin(), batchTargets.end(), [](const auto& a, const auto& b)
 				{
-					listenersToWake.push_back(it->second.lock());
-					it++;
+					return a.first.get() != b.first.get() ? a.first.get() < b.first.get() : a.second < b.second;
 				}
-				else
+			);
+			// 通知
+			for (size_t i = 0; i < batchTargets.size();)
+			{
+				batchSubset.clear();
+				size_t j = i;
+				for (; j < batchTargets.size() && batchTargets[j].first == batchTargets[i].first; ++j)
 				{
-					EventList.erase(it++);
+					EventID id = batchEvents[batchTargets[j].second];
+					if (batchSubset.empty() || batchSubset.back() != id)
+						batchSubset.push_back(id);
 				}
+				TANMI_METRIC(recordBatch(batchSubset));
+				postBatch(batchTargets[i].first, batchSubset);
+				i = j;
 			}
-			// ֪ͨ
+			// 清空缓冲
+			batchTargets.clear();
+		}
+		catch (EventSystemException& e)
+		{
+			std::cout << "::EventSystem::TriggerEvents()" << e.what() << std::endl;
+		}
+	}
+
+	inline void EventSystem::SetSubscriptionMatrix(bool enable)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		useMatrix = enable;
+		matrixDirty = true;
+	}
+
+	inline void EventSystem::SetMemoryResource(std::pmr::memory_resource* resource)
+	{
+		if (resource == nullptr)
+			resource = std::pmr::get_default_resource();
+		std::lock_guard<std::mutex> lock(mtx);
+		std::lock_guard<std::mutex> lock_temp(mtx_temp);
+		RebindResource(EventList, resource);
+		RebindResource(listenersToWake, resource);
+		RebindResource(eventsPreprocess, resource);
+		RebindResource(eventRoutes, resource);
+		RebindResource(staticRoutes, resource);
+		RebindResource(matrixAcc, resource);
+		RebindResource(matrixRows, resource);
+		RebindResource(batchEvents, resource);
+		RebindResource(batchTargets, resource);
+		RebindResource(batchSubset, resource);
+		RebindResource(batchPart, resource);
+		RebindResource(batchRest, resource);
+		matrix.SetMemoryResource(resource);
+		matrixDirty = true;
+	}
+
+	inline std::pmr::memory_resource* EventSystem::GetMemoryResource() const
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		return EventList.get_allocator().resource();
+	}
+
+	inline TriggerHandle EventSystem::TriggerEventTracked(const Event& event)
+	{
+		return TriggerEventTracked(event.ID);
+	}
+
+	inline TriggerHandle EventSystem::TriggerEventTracked(const EventID eventID)
+	{
+		TANMI_TRACE_POINT(TraceScope trace_scope(TraceType::TriggerBegin, TraceType::TriggerEnd, eventID));
+		TANMI_JOURNAL_POINT(EventJournal::Record(eventID));
+		try
+		{
+			std::lock_guard<std::mutex> lock_list(mtx);
+			std::lock_guard<std::mutex> lock(mtx_temp);
+			TANMI_METRIC(metricTriggers.Add());
+			// 寻找事件、预处理并压缓冲
+			if (collectListeners(eventID) == false)
+				return TriggerHandle();
+			if (listenersToWake.empty())
+				return TriggerHandle();
+			TANMI_METRIC(recordTrigger(eventID, listenersToWake.size()));
+			// 通知，计数须在发送前设置完毕
+			auto completion = std::make_shared<TriggerCompletion>((int)listenersToWake.size());
+			auto& handler = handlerOf(eventID);
 			for (auto& listener : listenersToWake)
 			{
-				messageHandlerUpdate->Post(event.ID, listener, ms);
+				handler.Post(eventID, listener, completion);
 			}
-			// ջ
+			// 清空缓冲
 			listenersToWake.clear();
+			return TriggerHandle(std::move(completion));
 		}
 		catch (EventSystemException& e)
 		{
-			std::cout << "::EventSystem::TriggerEventUpdate()" << e.what() << std::endl;
+			std::cout << "::EventSystem::TriggerEventTracked()" << e.what() << std::endl;
 		}
+		return TriggerHandle();
 	}
 
-	inline void EventSystem::TriggerEventUpdate(const EventID eventID, double ms)
+	inline TriggerHandle EventSystem::TriggerEventUpdateTracked(const Event& event, double ms)
+	{
+		return TriggerEventUpdateTracked(event.ID, ms);
+	}
+
+	inline TriggerHandle EventSystem::TriggerEventUpdateTracked(const EventID eventID, double ms)
 	{
+		TANMI_TRACE_POINT(TraceScope trace_scope(TraceType::TriggerBegin, TraceType::TriggerEnd, eventID));
+		TANMI_JOURNAL_POINT(EventJournal::Record(eventID, ms, true));
 		try
 		{
-			// Ѱ¼
-			auto range = EventList.equal_range(eventID);
-			if (std::distance(range.first, range.second) == 0)
-			{
-				throw EventSystemEventNotFoundException();
-			}
-			// Ԥ
-			if (eventsPreprocess[eventID]() == false)
-				return;
-			// λ
-			auto& it = range.first;
-			auto& it_end = range.second;
+			std::lock_guard<std::mutex> lock_list(mtx);
 			std::lock_guard<std::mutex> lock(mtx_temp);
-			// ѹ
-			while (it != it_end)
-			{
-				if (!it->second.expired())
-				{
-					listenersToWake.push_back(it->second.lock());
-					it++;
-				}
-				else
-				{
-					EventList.erase(it++);
-				}
-			}
-			// ֪ͨ
+			TANMI_METRIC(metricTriggers.Add());
+			// 寻找事件、预处理并压缓冲
+			if (collectListeners(eventID) == false)
+				return TriggerHandle();
+			if (listenersToWake.empty())
+				return TriggerHandle();
+			TANMI_METRIC(recordTrigger(eventID, listenersToWake.size()));
+			// 通知，计数须在发送前设置完毕
+			auto completion = std::make_shared<TriggerCompletion>((int)listenersToWake.size());
+			auto& handler = handlerUpdateOf(eventID);
 			for (auto& listener : listenersToWake)
 			{
-				messageHandlerUpdate->Post(eventID, listener, ms);
+				handler.Post(eventID, listener, ms, completion);
 			}
-			// ջ
+			// 清空缓冲
 			listenersToWake.clear();
+			return TriggerHandle(std::move(completion));
 		}
 		catch (EventSystemException& e)
 		{
-			std::cout << "::EventSystem::TriggerEventUpdate()" << e.what() << std::endl;
+			std::cout << "::EventSystem::TriggerEventUpdateTracked()" << e.what() << std::endl;
 		}
+		return TriggerHandle();
 	}
 
 	inline void EventSystem::AddEventHandler(const Event& event, std::shared_ptr<Listener> client)
@@ -605,6 +1464,63 @@ namespace TanmiEngine
 		std::lock_guard<std::mutex> lock(mtx);
 		std::weak_ptr<Listener> _client = client;
 		EventList.insert(std::make_pair(event.ID, std::move(_client)));
+		matrixDirty = true;
+	}
+
+	inline size_t EventSystem::AddTopicHandler(const std::string& pattern, std::shared_ptr<Listener> client)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		std::weak_ptr<Listener> _client = client;
+		topicHandlers.emplace_back(pattern, _client);
+		size_t count = 0;
+		for (auto& topic : topics)
+		{
+			if (IsTopicMatch(pattern, topic.first))
+			{
+				EventList.insert(std::make_pair(topic.second, _client));
+				matrixDirty = true;
+				++count;
+			}
+		}
+		return count;
+	}
+
+	inline void EventSystem::RemoveTopicHandler(const std::string& pattern, std::shared_ptr<Listener> client)
+	{
+		try
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			auto it = std::find_if(topicHandlers.begin(), topicHandlers.end(), [&](const auto& handler)
+				{
+					return handler.first == pattern && handler.second.lock() == client;
+				}
+			);
+			if (it == topicHandlers.end())
+			{
+				throw EventSystemListenerNotFoundException();
+			}
+			topicHandlers.erase(it);
+			// 每个匹配事件解除一个绑定，与订阅时的绑定一一对应
+			for (auto& topic : topics)
+			{
+				if (IsTopicMatch(pattern, topic.first) == false)
+					continue;
+				auto range = EventList.equal_range(topic.second);
+				for (auto e = range.first; e != range.second; ++e)
+				{
+					if (e->second.lock() == client)
+					{
+						EventList.erase(e);
+						matrixDirty = true;
+						break;
+					}
+				}
+			}
+		}
+		catch (EventSystemException& e)
+		{
+			std::cout << "::EventSystem::RemoveTopicHandler()" << e.what() << std::endl;
+		}
 	}
 
 	template<EventContainer T>
@@ -615,6 +1531,7 @@ namespace TanmiEngine
 		for (auto e : events)
 		{
 			EventList.insert(std::make_pair(e.ID, _client));
+			matrixDirty = true;
 		}
 	}
 
@@ -626,6 +1543,7 @@ namespace TanmiEngine
 		{
 			std::weak_ptr<Listener> _client = e;
 			EventList.insert(std::make_pair(event.ID, std::move(_client)));
+			matrixDirty = true;
 		}
 	}
 
@@ -647,6 +1565,7 @@ namespace TanmiEngine
 			if (it != range.second)
 			{
 				EventList.erase(it);
+				matrixDirty = true;
 			}
 			else
 			{
@@ -659,6 +1578,22 @@ namespace TanmiEngine
 		}
 	}
 
+	inline bool EventSystem::RemoveEventHandlerNoException(const EventID eventID, std::shared_ptr<Listener> client)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		auto range = EventList.equal_range(eventID);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (it->second.lock() == client)
+			{
+				EventList.erase(it);
+				matrixDirty = true;
+				return true;
+			}
+		}
+		return false;
+	}
+
 	inline void EventSystem::RemoveAllEventForEventName(const Event& event)
 	{
 		try
@@ -669,6 +1604,7 @@ namespace TanmiEngine
 			}
 			std::lock_guard<std::mutex> lock(mtx);
 			EventList.erase(event.ID);
+			matrixDirty = true;
 		}
 		catch (EventSystemException& e)
 		{
@@ -676,7 +1612,7 @@ namespace TanmiEngine
 		}
 	}
 	//
-	// Чʵ
+	// 效率低
 	//
 	inline void EventSystem::RemoveAllEventForListener(const std::shared_ptr<Listener> client)
 	{
@@ -690,6 +1626,7 @@ namespace TanmiEngine
 				if (it->second.lock() && it->second.lock() == client)
 				{
 					it = EventList.erase(it);
+					matrixDirty = true;
 					isExist = true;
 				}
 				else
@@ -736,15 +1673,104 @@ namespace TanmiEngine
 		return false;
 	}
 
+	inline EventSystemMetricsSnapshot EventSystem::GetMetrics()
+	{
+		EventSystemMetricsSnapshot snapshot;
+#ifdef TANMI_METRICS
+		// 处理器可能被同时更换，在锁内复制指针后于锁外读取其指标
+		std::shared_ptr<MessageHandler> _messageHandler;
+		std::shared_ptr<MessageHandlerUpdate> _messageHandlerUpdate;
+		std::vector<HandlerRoute> _routes;
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			_messageHandler = messageHandler;
+			_messageHandlerUpdate = messageHandlerUpdate;
+			_routes.assign(routes.begin() + 1, routes.end());
+			snapshot.triggers = metricTriggers.Value();
+			snapshot.suppressed = metricSuppressed.Value();
+			snapshot.not_found = metricNotFound.Value();
+			snapshot.posted = metricPosted.Value();
+			for (auto& e : eventMetrics)
+				snapshot.events.push_back(e.second);
+		}
+		std::sort(snapshot.events.begin(), snapshot.events.end(), [](const auto& a, const auto& b)
+			{
+				return a.id < b.id;
+			}
+		);
+		if (_messageHandler)
+			snapshot.handler = _messageHandler->GetMetrics();
+		if (_messageHandlerUpdate)
+			snapshot.handler_update = _messageHandlerUpdate->GetMetrics();
+		for (auto& route : _routes)
+		{
+			RouteMetricsSnapshot metric;
+			metric.name = route.name;
+			if (route.handler)
+				metric.handler = route.handler->GetMetrics();
+			if (route.handlerUpdate)
+				metric.handler_update = route.handlerUpdate->GetMetrics();
+			snapshot.routes.push_back(std::move(metric));
+		}
+#endif // TANMI_METRICS
+		return snapshot;
+	}
+
+	inline void EventSystem::ResetMetrics()
+	{
+#ifdef TANMI_METRICS
+		std::shared_ptr<MessageHandler> _messageHandler;
+		std::shared_ptr<MessageHandlerUpdate> _messageHandlerUpdate;
+		std::vector<HandlerRoute> _routes;
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			_messageHandler = messageHandler;
+			_messageHandlerUpdate = messageHandlerUpdate;
+			_routes.assign(routes.begin() + 1, routes.end());
+			metricTriggers.Reset();
+			metricSuppressed.Reset();
+			metricNotFound.Reset();
+			metricPosted.Reset();
+			eventMetrics.clear();
+		}
+		if (_messageHandler)
+			_messageHandler->ResetMetrics();
+		if (_messageHandlerUpdate)
+			_messageHandlerUpdate->ResetMetrics();
+		for (auto& route : _routes)
+		{
+			if (route.handler)
+				route.handler->ResetMetrics();
+			if (route.handlerUpdate)
+				route.handlerUpdate->ResetMetrics();
+		}
+#endif // TANMI_METRICS
+	}
+
 	inline EventSystem::~EventSystem()
 	{
 		if (isMessageHandlerRegisted)
 		{
 			messageHandler->Exit();
+			messageHandler->Join();
 		}
 		if (isMessageHandlerUpdateRegisted)
 		{
 			messageHandlerUpdate->Exit();
+			messageHandlerUpdate->Join();
+		}
+		for (auto& route : routes)
+		{
+			if (route.handler)
+			{
+				route.handler->Exit();
+				route.handler->Join();
+			}
+			if (route.handlerUpdate)
+			{
+				route.handlerUpdate->Exit();
+				route.handlerUpdate->Join();
+			}
 		}
 	}
 
@@ -761,13 +1787,7 @@ namespace TanmiEngine
 			_messageHandler = std::make_shared<T>(std::forward<P>(pram)...);
 		}
 
-		if (isMessageHandlerRegisted)
-			messageHandler->Exit();
-		messageHandler = _messageHandler;
-
-		std::thread thread(&MessageHandler::Run, _messageHandler.get());
-		thread.detach();
-		isMessageHandlerRegisted = true;
+		RegisterMessageHandler(_messageHandler, true);
 		return _messageHandler;
 	}
 
@@ -784,13 +1804,7 @@ namespace TanmiEngine
 			_messageHandlerUpdate = std::make_shared<T>(std::forward<P>(pram)...);
 		}
 
-		if (isMessageHandlerUpdateRegisted)
-			messageHandlerUpdate->Exit();
-		messageHandlerUpdate = _messageHandlerUpdate;
-
-		std::thread thread(&MessageHandlerUpdate::Run, _messageHandlerUpdate.get());
-		thread.detach();
-		isMessageHandlerUpdateRegisted = true;
+		RegisterMessageHandlerUpdate(_messageHandlerUpdate, true);
 		return _messageHandlerUpdate;
 	}
 }
\ No newline at end of file
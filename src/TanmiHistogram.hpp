@@ -0,0 +1,186 @@
+#pragma once
+/*****************************************************************//**
+ * \file   TanmiHistogram.hpp
+ * \brief  无锁直方图
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <atomic>
+#include <bit>
+#include <string>
+#include <vector>
+
+namespace TanmiEngine
+{
+	/**
+	 * @brief 直方图快照
+	 */
+	struct HistogramSnapshot
+	{
+		unsigned long long count = 0;	///< 样本数
+		unsigned long long sum = 0;		///< 样本总和
+		unsigned long long min = 0;		///< 最小值
+		unsigned long long max = 0;		///< 最大值
+		std::vector<std::pair<unsigned long long, unsigned long long>> buckets;	///< 非空桶 <桶上界, 样本数>
+
+		/**
+		 * @brief 获取平均值
+		 *
+		 * @return double 平均值
+		 */
+		double Mean() const
+		{
+			return count == 0 ? 0 : (double)sum / count;
+		}
+		/**
+		 * @brief 获取百分位数（桶上界，误差不超过12.5%）
+		 *
+		 * @param p 百分位，范围[0, 100]
+		 * @return unsigned long long 百分位数
+		 */
+		unsigned long long Percentile(double p) const
+		{
+			if (count == 0)
+				return 0;
+			unsigned long long rank = (unsigned long long)(p / 100.0 * count);
+			if (rank >= count)
+				rank = count - 1;
+			unsigned long long seen = 0;
+			for (auto& b : buckets)
+			{
+				seen += b.second;
+				if (seen > rank)
+					return b.first < max ? b.first : max;
+			}
+			return max;
+		}
+		/**
+		 * @brief 以JSON格式输出
+		 *
+		 * @return std::string JSON字符串
+		 */
+		std::string ToJson() const
+		{
+			std::string json = "{\"count\":" + std::to_string(count)
+				+ ",\"min\":" + std::to_string(min)
+				+ ",\"max\":" + std::to_string(max)
+				+ ",\"mean\":" + std::to_string(Mean())
+				+ ",\"p50\":" + std::to_string(Percentile(50))
+				+ ",\"p90\":" + std::to_string(Percentile(90))
+				+ ",\"p99\":" + std::to_string(Percentile(99))
+				+ ",\"p999\":" + std::to_string(Percentile(99.9))
+				+ ",\"buckets\":[";
+			for (size_t i = 0; i < buckets.size(); ++i)
+			{
+				if (i != 0)
+					json += ",";
+				json += "[" + std::to_string(buckets[i].first) + "," + std::to_string(buckets[i].second) + "]";
+			}
+			json += "]}";
+			return json;
+		}
+	};
+
+	/**
+	 * @brief 对数-线性分桶的无锁直方图
+	 *
+	 * 每个二次幂区间等分为8个桶，记录仅需若干次relaxed原子操作，可由多个线程同时写入
+	 */
+	class Histogram
+	{
+	public:
+		static constexpr int SUB_BITS = 3;							///< 每个二次幂区间的子桶位数
+		static constexpr int SUB_COUNT = 1 << SUB_BITS;				///< 每个二次幂区间的子桶数
+		static constexpr int BUCKET_COUNT = (64 - SUB_BITS + 1) * SUB_COUNT;	///< 桶总数
+
+		Histogram()
+		{
+			Reset();
+		}
+		Histogram(const Histogram&) = delete;				//< 禁止拷贝构造
+		Histogram& operator=(const Histogram&) = delete;	//< 禁止拷贝赋值
+		~Histogram() = default;
+
+		/**
+		 * @brief 记录一个样本
+		 *
+		 * @param value 样本值
+		 */
+		void Record(unsigned long long value) noexcept
+		{
+			buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+			count.fetch_add(1, std::memory_order_relaxed);
+			sum.fetch_add(value, std::memory_order_relaxed);
+			auto cur = max.load(std::memory_order_relaxed);
+			while (value > cur && !max.compare_exchange_weak(cur, value, std::memory_order_relaxed));
+			cur = min.load(std::memory_order_relaxed);
+			while (value < cur && !min.compare_exchange_weak(cur, value, std::memory_order_relaxed));
+		}
+		/**
+		 * @brief 清空所有样本
+		 */
+		void Reset() noexcept
+		{
+			for (auto& b : buckets)
+				b.store(0, std::memory_order_relaxed);
+			count.store(0, std::memory_order_relaxed);
+			sum.store(0, std::memory_order_relaxed);
+			max.store(0, std::memory_order_relaxed);
+			min.store(~0ull, std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 获取快照，写入过程中获取的快照各项之间可能存在少量偏差
+		 *
+		 * @return HistogramSnapshot 直方图快照
+		 */
+		HistogramSnapshot Snapshot() const
+		{
+			HistogramSnapshot snapshot;
+			for (int i = 0; i < BUCKET_COUNT; ++i)
+			{
+				auto n = buckets[i].load(std::memory_order_relaxed);
+				if (n != 0)
+				{
+					snapshot.buckets.emplace_back(bucketUpper(i), n);
+					snapshot.count += n;
+				}
+			}
+			snapshot.sum = sum.load(std::memory_order_relaxed);
+			snapshot.max = max.load(std::memory_order_relaxed);
+			snapshot.min = snapshot.count == 0 ? 0 : min.load(std::memory_order_relaxed);
+			return snapshot;
+		}
+
+	private:
+		/**
+		 * @brief 计算样本所在桶
+		 */
+		static int bucketIndex(unsigned long long value) noexcept
+		{
+			if (value < SUB_COUNT)
+				return (int)value;
+			int msb = std::bit_width(value) - 1;
+			int sub = (int)(value >> (msb - SUB_BITS)) & (SUB_COUNT - 1);
+			return (msb - SUB_BITS + 1) * SUB_COUNT + sub;
+		}
+		/**
+		 * @brief 计算桶的上界（含）
+		 */
+		static unsigned long long bucketUpper(int index) noexcept
+		{
+			if (index < SUB_COUNT)
+				return index;
+			int msb = index / SUB_COUNT + SUB_BITS - 1;
+			unsigned long long sub = index % SUB_COUNT;
+			unsigned long long width = 1ull << (msb - SUB_BITS);
+			return ((SUB_COUNT + sub) << (msb - SUB_BITS)) + width - 1;
+		}
+
+		std::atomic<unsigned long long> buckets[BUCKET_COUNT];	//< 各桶样本数
+		std::atomic<unsigned long long> count;	//< 样本数
+		std::atomic<unsigned long long> sum;	//< 样本总和
+		std::atomic<unsigned long long> max;	//< 最大值
+		std::atomic<unsigned long long> min;	//< 最小值
+	};
+}
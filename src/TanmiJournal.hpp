@@ -0,0 +1,381 @@
+#pragma once
+/*****************************************************************//**
+ * \file   TanmiJournal.hpp
+ * \brief  事件日志，以内存映射文件记录所有触发并支持回放
+ *
+ * 定义 TANMI_JOURNAL 后事件系统的触发接口写入日志，未定义时记录点不参与编译
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TANMI_JOURNAL_MMAP
+#endif
+
+#include "TanmiEvent.hpp"
+#include "TanmiTrace.hpp"
+
+namespace TanmiEngine
+{
+	/**
+	 * @brief 日志记录，24字节
+	 */
+	struct JournalRecord
+	{
+		static constexpr uint16_t VALID = 1;	///< 记录已写入
+		static constexpr uint16_t UPDATE = 2;	///< 带有时间参数的触发
+
+		uint64_t timestamp;	///< 时间戳（计数器周期）
+		EventID id;			///< 事件ID
+		uint16_t thread;	///< 生产者线程序号
+		uint16_t flags;		///< 标志位
+		double ms;			///< 时间参数，仅 UPDATE 有效
+	};
+	static_assert(sizeof(JournalRecord) == 24);
+
+	/**
+	 * @brief 日志文件头，64字节
+	 */
+	struct JournalHeader
+	{
+		static constexpr uint64_t MAGIC = 0x314C4E524A4D4E54ull;	///< "TNMJRNL1"
+
+		uint64_t magic;					///< 文件标识
+		uint32_t version;				///< 格式版本
+		uint32_t record_size;			///< 单条记录字节数
+		uint64_t capacity;				///< 可容纳的记录数量
+		std::atomic<uint64_t> reserved;	///< 已分配的记录数量，可能超过 capacity
+		double ns_per_tick;				///< 每个计数器周期的纳秒数
+		uint64_t base_tick;				///< 开始记录时的计数器
+		uint64_t wall_time_ns;			///< 开始记录时的系统时间（纳秒）
+		uint64_t padding;				///< 填充
+	};
+	static_assert(sizeof(JournalHeader) == 64);
+
+	/**
+	 * @brief 事件日志记录器
+	 *
+	 * 日志文件在打开时按容量预分配并映射至内存。各线程每次从文件中预留一段连续记录（CHUNK_SIZE条），
+	 * 此后直接写入映射区域，仅在预留段用完时进行一次原子操作；记录写满容量后丢弃并计数。
+	 * 文件中的记录按线程分段存放，回放前须按时间戳排序，未写满的预留段以 VALID 标志区分。
+	 * 调用 Close 前应先停止所有触发
+	 */
+	class EventJournal
+	{
+	public:
+		static constexpr size_t CHUNK_SIZE = 256;	///< 每次预留的记录数量
+
+		/**
+		 * @brief 获取EventJournal实例引用
+		 */
+		static EventJournal& Instance()
+		{
+			static EventJournal journal;
+			return journal;
+		}
+		~EventJournal()
+		{
+			Close();
+		}
+		/**
+		 * @brief 创建日志文件并开始记录
+		 *
+		 * @param path 文件路径，已存在时覆盖
+		 * @param capacity 可容纳的记录数量
+		 * @return true 开始记录
+		 * @return false 文件创建或映射失败，或当前平台不支持
+		 */
+		bool Open(const std::string& path, size_t capacity)
+		{
+			Close();
+#ifdef TANMI_JOURNAL_MMAP
+			size_t bytes = sizeof(JournalHeader) + capacity * sizeof(JournalRecord);
+			int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+			if (fd < 0)
+				return false;
+			if (::ftruncate(fd, (off_t)bytes) != 0)
+			{
+				::close(fd);
+				return false;
+			}
+			void* addr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			::close(fd);
+			if (addr == MAP_FAILED)
+				return false;
+			base = (char*)addr;
+			size = bytes;
+			header = new (base) JournalHeader{ JournalHeader::MAGIC, 1, sizeof(JournalRecord), capacity, {0},
+				0, Tracer::Now(), (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count(), 0 };
+			records = (JournalRecord*)(base + sizeof(JournalHeader));
+			base_time = std::chrono::steady_clock::now();
+			dropped.store(0, std::memory_order_relaxed);
+			threads.store(0, std::memory_order_relaxed);
+			epoch.fetch_add(1, std::memory_order_relaxed);
+			recording.store(true, std::memory_order_release);
+			return true;
+#else
+			return false;
+#endif // TANMI_JOURNAL_MMAP
+		}
+		/**
+		 * @brief 停止记录，写入计数器换算比例并关闭文件
+		 */
+		void Close()
+		{
+#ifdef TANMI_JOURNAL_MMAP
+			if (base == nullptr)
+				return;
+			recording.store(false, std::memory_order_release);
+			uint64_t ticks = Tracer::Now() - header->base_tick;
+			double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - base_time).count();
+			header->ns_per_tick = ticks == 0 ? 1.0 : ns / ticks;
+			::msync(base, size, MS_SYNC);
+			::munmap(base, size);
+			base = nullptr;
+			header = nullptr;
+			records = nullptr;
+#endif // TANMI_JOURNAL_MMAP
+		}
+		/**
+		 * @brief 是否正在记录
+		 */
+		bool IsRecording() const
+		{
+			return recording.load(std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 获取因容量不足丢弃的记录数量
+		 */
+		uint64_t Dropped() const
+		{
+			return dropped.load(std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 写入一条触发记录
+		 *
+		 * @param id 事件ID
+		 * @param ms 时间参数
+		 * @param update 是否为带有时间参数的触发
+		 */
+		static void Record(EventID id, double ms = 0, bool update = false)
+		{
+			EventJournal& journal = Instance();
+			if (journal.recording.load(std::memory_order_acquire) == false)
+				return;
+			thread_local ThreadChunk chunk;
+			if (chunk.epoch != journal.epoch.load(std::memory_order_relaxed) || chunk.next == chunk.end)
+			{
+				if (journal.reserve(chunk) == false)
+				{
+					journal.dropped.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+			chunk.next->timestamp = Tracer::Now();
+			chunk.next->id = id;
+			chunk.next->thread = chunk.thread;
+			chunk.next->ms = ms;
+			// 标志位最后写入，读取方以此判断记录是否完整
+			std::atomic_ref<uint16_t>(chunk.next->flags).store(JournalRecord::VALID | (update ? JournalRecord::UPDATE : 0), std::memory_order_release);
+			++chunk.next;
+		}
+	private:
+		/**
+		 * @brief 线程当前预留的记录段
+		 */
+		struct ThreadChunk
+		{
+			JournalRecord* next = nullptr;	//< 下一条记录
+			JournalRecord* end = nullptr;	//< 预留段末尾
+			uint64_t epoch = 0;				//< 预留时的日志序号
+			uint16_t thread = 0;			//< 线程序号
+		};
+
+		EventJournal() = default;
+		/**
+		 * @brief 为当前线程预留新的记录段
+		 *
+		 * @return true 预留成功
+		 * @return false 容量已满
+		 */
+		bool reserve(ThreadChunk& chunk)
+		{
+			uint64_t current = epoch.load(std::memory_order_relaxed);
+			if (chunk.epoch != current)
+			{
+				chunk.epoch = current;
+				chunk.thread = (uint16_t)threads.fetch_add(1, std::memory_order_relaxed);
+				chunk.next = chunk.end = nullptr;
+			}
+			if (header->reserved.load(std::memory_order_relaxed) >= header->capacity)
+			{
+				chunk.next = chunk.end = nullptr;
+				return false;
+			}
+			// 顺带更新换算比例，异常退出时文件中仍保留近似值
+			uint64_t ticks = Tracer::Now() - header->base_tick;
+			double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - base_time).count();
+			if (ticks != 0)
+				std::atomic_ref<double>(header->ns_per_tick).store(ns / ticks, std::memory_order_relaxed);
+			uint64_t begin = header->reserved.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+			if (begin >= header->capacity)
+			{
+				chunk.next = chunk.end = nullptr;
+				return false;
+			}
+			chunk.next = records + begin;
+			chunk.end = records + std::min<uint64_t>(begin + CHUNK_SIZE, header->capacity);
+			return true;
+		}
+
+		std::atomic<bool> recording{ false };		//< 是否正在记录
+		std::atomic<uint64_t> epoch{ 0 };			//< 日志序号，每次打开递增，使各线程旧的预留段失效
+		std::atomic<uint32_t> threads{ 0 };			//< 已分配的线程序号数量
+		std::atomic<uint64_t> dropped{ 0 };			//< 丢弃的记录数量
+		char* base = nullptr;						//< 映射区域
+		size_t size = 0;							//< 映射区域字节数
+		JournalHeader* header = nullptr;			//< 文件头
+		JournalRecord* records = nullptr;			//< 记录区
+		std::chrono::steady_clock::time_point base_time;	//< 开始记录时的真实时间
+	};
+
+	/**
+	 * @brief 事件日志回放器
+	 *
+	 * 读取日志文件中所有完整的记录并按时间戳排序，可按原始节奏、指定倍速或最快速度重新触发至事件系统
+	 */
+	class JournalReplayer
+	{
+	public:
+		/**
+		 * @brief 读取日志文件
+		 *
+		 * @param path 文件路径
+		 * @return true 读取成功
+		 * @return false 文件不存在、格式不符或当前平台不支持
+		 */
+		bool Open(const std::string& path)
+		{
+			records.clear();
+#ifdef TANMI_JOURNAL_MMAP
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0)
+				return false;
+			struct stat st;
+			if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(JournalHeader))
+			{
+				::close(fd);
+				return false;
+			}
+			void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd);
+			if (addr == MAP_FAILED)
+				return false;
+			const JournalHeader* header = (const JournalHeader*)addr;
+			bool valid = header->magic == JournalHeader::MAGIC && header->record_size == sizeof(JournalRecord)
+				&& sizeof(JournalHeader) + header->capacity * sizeof(JournalRecord) <= (size_t)st.st_size;
+			if (valid)
+			{
+				ns_per_tick = header->ns_per_tick > 0 ? header->ns_per_tick : 1.0;
+				wall_time_ns = header->wall_time_ns;
+				uint64_t count = std::min(header->reserved.load(std::memory_order_relaxed), header->capacity);
+				const JournalRecord* begin = (const JournalRecord*)((const char*)addr + sizeof(JournalHeader));
+				for (uint64_t i = 0; i < count; ++i)
+				{
+					if (begin[i].flags & JournalRecord::VALID)
+						records.push_back(begin[i]);
+				}
+				std::stable_sort(records.begin(), records.end(), [](const JournalRecord& a, const JournalRecord& b)
+					{
+						return a.timestamp < b.timestamp;
+					});
+			}
+			::munmap(addr, st.st_size);
+			return valid;
+#else
+			return false;
+#endif // TANMI_JOURNAL_MMAP
+		}
+		/**
+		 * @brief 获取按时间排序的所有记录
+		 */
+		std::span<const JournalRecord> Records() const
+		{
+			return records;
+		}
+		/**
+		 * @brief 获取记录的持续时长（纳秒）
+		 */
+		double DurationNs() const
+		{
+			return records.empty() ? 0 : (records.back().timestamp - records.front().timestamp) * ns_per_tick;
+		}
+		/**
+		 * @brief 获取开始记录时的系统时间（纳秒）
+		 */
+		uint64_t WallTimeNs() const
+		{
+			return wall_time_ns;
+		}
+		/**
+		 * @brief 将所有记录重新触发至事件系统
+		 *
+		 * @tparam System 事件系统类型，须提供 TriggerEvent(EventID) 与 TriggerEventUpdate(EventID, double)
+		 * @param system 事件系统
+		 * @param speed 回放倍速，1.0为原始节奏，小于等于0时以最快速度回放
+		 * @param map 事件ID映射，用于ID在两次运行间不同的事件，为空时使用原ID
+		 * @return size_t 触发次数
+		 */
+		template<typename System>
+		size_t Replay(System& system, double speed = 1.0, const std::function<EventID(EventID)>& map = nullptr) const
+		{
+			if (records.empty())
+				return 0;
+			auto start = std::chrono::steady_clock::now();
+			uint64_t first = records.front().timestamp;
+			for (auto& r : records)
+			{
+				if (speed > 0)
+				{
+					auto due = start + std::chrono::nanoseconds((long long)((r.timestamp - first) * ns_per_tick / speed));
+					// 较长的间隔先休眠，最后一段忙等以保证精度
+					auto now = std::chrono::steady_clock::now();
+					if (due - now > std::chrono::microseconds(200))
+						std::this_thread::sleep_until(due - std::chrono::microseconds(100));
+					while (std::chrono::steady_clock::now() < due);
+				}
+				EventID id = map ? map(r.id) : r.id;
+				if (r.flags & JournalRecord::UPDATE)
+					system.TriggerEventUpdate(id, r.ms);
+				else
+					system.TriggerEvent(id);
+			}
+			return records.size();
+		}
+	private:
+		std::vector<JournalRecord> records;	//< 按时间排序的记录
+		double ns_per_tick = 1.0;			//< 每个计数器周期的纳秒数
+		uint64_t wall_time_ns = 0;			//< 开始记录时的系统时间
+	};
+}
+
+#ifdef TANMI_JOURNAL
+#define TANMI_JOURNAL_POINT(...) __VA_ARGS__
+#else
+#define TANMI_JOURNAL_POINT(...)
+#endif // TANMI_JOURNAL
\ No newline at end of file
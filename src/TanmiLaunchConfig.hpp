@@ -0,0 +1,178 @@
+#pragma once
+/*****************************************************************//**
+ * \file   TanmiLaunchConfig.hpp
+ * \brief  消息处理线程的启动配置
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <iostream>
+#include <exception>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // __linux__
+
+namespace TanmiEngine
+{
+	/**
+	 * @brief 启动配置异常基类。
+	 */
+	class LaunchConfigException : public std::exception
+	{
+	public:
+		virtual const char* what() const throw ()
+		{
+			return "::Expection Launch Config Exception basic";
+		}
+	};
+	/**
+	 * @brief CPU亲和性设置失败异常类。
+	 */
+	class AffinityFailedException : public LaunchConfigException
+	{
+	public:
+		virtual const char* what() const throw ()
+		{
+			return "::Expection affinity_failed";
+		}
+	};
+	/**
+	 * @brief 调度策略设置失败异常类，实时调度通常需要 CAP_SYS_NICE 权限。
+	 */
+	class SchedulingFailedException : public LaunchConfigException
+	{
+	public:
+		virtual const char* what() const throw ()
+		{
+			return "::Expection scheduling_failed";
+		}
+	};
+	/**
+	 * @brief 线程命名失败异常类。
+	 */
+	class ThreadNameFailedException : public LaunchConfigException
+	{
+	public:
+		virtual const char* what() const throw ()
+		{
+			return "::Expection thread_name_failed";
+		}
+	};
+
+	/**
+	 * @brief 处理线程调度策略
+	 */
+	enum class SchedPolicy
+	{
+		Default,	///< 普通分时调度，使用 nice 值
+		Fifo,		///< SCHED_FIFO 实时调度，使用 priority
+		RoundRobin,	///< SCHED_RR 实时调度，使用 priority
+	};
+
+	/**
+	 * @brief 消息处理器的启动配置，在处理线程启动时于线程内应用
+	 *
+	 * 各项设置仅在Linux下生效，其他平台忽略；
+	 * NUMA本地内存不在启动配置的范围内，消息队列在构造时分配，需要时可向处理器构造函数传入节点本地的 memory_resource
+	 */
+	struct HandlerLaunchConfig
+	{
+		std::string name;					///< 线程名称，为空时不设置；超过15字节的部分被截断，多个处理线程时截断后追加序号
+		std::vector<int> cpus;				///< 允许运行的CPU列表（0 ~ CPU_SETSIZE-1），为空时不限制
+		bool pin_each = false;				///< 是否将各处理线程按序号轮流绑定至 cpus 中的单个CPU
+		SchedPolicy policy = SchedPolicy::Default;	///< 调度策略
+		int priority = 1;					///< 实时优先级（1~99），仅实时调度有效
+		int nice = 0;						///< nice值（-20~19），仅普通调度有效，为0时不设置
+		size_t workers = 1;					///< 处理线程数量，大于1时同一监听器可能被并发唤醒，且不保证消息顺序
+	};
+
+	/**
+	 * @brief 在当前线程中应用启动配置，失败的设置输出异常信息后跳过
+	 *
+	 * @param config 启动配置
+	 * @param index 处理线程序号
+	 * @return true 全部设置成功
+	 * @return false 部分设置失败
+	 */
+	inline bool ApplyLaunchConfig(const HandlerLaunchConfig& config, size_t index)
+	{
+		bool ok = true;
+#ifdef __linux__
+		try
+		{
+			if (config.cpus.empty() == false)
+			{
+				for (auto cpu : config.cpus)
+				{
+					if (cpu < 0 || cpu >= CPU_SETSIZE)
+						throw AffinityFailedException();
+				}
+				cpu_set_t set;
+				CPU_ZERO(&set);
+				if (config.pin_each)
+				{
+					CPU_SET(config.cpus[index % config.cpus.size()], &set);
+				}
+				else
+				{
+					for (auto cpu : config.cpus)
+						CPU_SET(cpu, &set);
+				}
+				if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+					throw AffinityFailedException();
+			}
+		}
+		catch (LaunchConfigException& e)
+		{
+			ok = false;
+			std::cout << "\n::ApplyLaunchConfig()" << e.what() << std::endl;
+		}
+		try
+		{
+			if (config.policy != SchedPolicy::Default)
+			{
+				sched_param param{};
+				param.sched_priority = config.priority;
+				if (pthread_setschedparam(pthread_self(), config.policy == SchedPolicy::Fifo ? SCHED_FIFO : SCHED_RR, &param) != 0)
+					throw SchedulingFailedException();
+			}
+			else if (config.nice != 0)
+			{
+				// Linux下 nice 值属于线程
+				if (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), config.nice) != 0)
+					throw SchedulingFailedException();
+			}
+		}
+		catch (LaunchConfigException& e)
+		{
+			ok = false;
+			std::cout << "\n::ApplyLaunchConfig()" << e.what() << std::endl;
+		}
+		try
+		{
+			if (config.name.empty() == false)
+			{
+				// 先截断名称再追加序号，使各处理线程的名称保持可区分
+				std::string suffix = config.workers > 1 ? "-" + std::to_string(index) : std::string();
+				std::string name = config.name.substr(0, suffix.size() < 15 ? 15 - suffix.size() : 0) + suffix;
+				if (name.size() > 15)
+					name.resize(15);
+				if (pthread_setname_np(pthread_self(), name.c_str()) != 0)
+					throw ThreadNameFailedException();
+			}
+		}
+		catch (LaunchConfigException& e)
+		{
+			ok = false;
+			std::cout << "\n::ApplyLaunchConfig()" << e.what() << std::endl;
+		}
+#endif // __linux__
+		return ok;
+	}
+}
\ No newline at end of file
@@ -1,38 +1,61 @@
 #pragma once
 /*****************************************************************//**
  * \file   TanmiListener.hpp
- * \brief  
+ * \brief  监听器基类
  * 
  * \author tanmika
  * \date   April 2023
  *********************************************************************/
+#include <span>
+
 using EventID = int;
 namespace TanmiEngine {
 	/**
-	 * @brief 
+	 * @brief 监听器基类
 	 */
 	class Listener
 	{
 	public:
 		/**
-		 * @brief ĬϹ캯
+		 * @brief 默认构造函数
 		 */
 		Listener() = default;
 		/**
-		 * @brief Ĭ
+		 * @brief 默认析构函数
 		 */
 		virtual ~Listener() = default;
 		/**
-		 * @brief ¼Ӧ
+		 * @brief 事件响应函数
 		 * 
-		 * @param event ¼ID
+		 * @param event 事件ID
 		 */
 		virtual void WakeEvent(const EventID event) = 0;
-        /* @brief ¼Ӧ
+        /* @brief 事件响应函数
 		 * 
-		 * @param event ¼ID
-		 * @param ms    ¼ʱ䣨ԺΪλ
+		 * @param event 事件ID
+		 * @param ms    事件发生所经过的时间（以毫秒为单位）
 		 */
 		virtual void WakeEventUpdate(const EventID event, double ms) = 0;
+		/**
+		 * @brief 批量事件响应函数，默认逐个调用 WakeEvent
+		 * 
+		 * @param events 事件ID列表
+		 */
+		virtual void WakeEventBatch(std::span<const EventID> events)
+		{
+			for (auto event : events)
+				WakeEvent(event);
+		}
+		/**
+		 * @brief 批量事件响应函数（带有时间参数），默认逐个调用 WakeEventUpdate
+		 * 
+		 * @param events 事件ID列表
+		 * @param ms     与events一一对应的事件发生所经过的时间（以毫秒为单位）
+		 */
+		virtual void WakeEventUpdateBatch(std::span<const EventID> events, std::span<const double> ms)
+		{
+			for (size_t i = 0; i < events.size(); ++i)
+				WakeEventUpdate(events[i], ms[i]);
+		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+/*****************************************************************//**
+ * \file   TanmiMemory.hpp
+ * \brief  事件系统使用的内存资源
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace TanmiEngine
+{
+	/**
+	 * @brief 事件系统内部节点的池配置
+	 *
+	 * 订阅节点（约64字节）、消息队列的分块（约512字节）与分块索引、时钟元素均落在池的尺寸范围内
+	 */
+	inline std::pmr::pool_options EventPoolOptions()
+	{
+		std::pmr::pool_options options;
+		options.max_blocks_per_chunk = 1024;
+		options.largest_required_pool_block = 4096;
+		return options;
+	}
+
+	/**
+	 * @brief 线程安全的池资源，释放的节点按尺寸回收复用，稳定运行后不再向上游申请内存
+	 */
+	class EventPoolResource : public std::pmr::synchronized_pool_resource
+	{
+	public:
+		/**
+		 * @brief 构造函数
+		 *
+		 * @param upstream 上游资源
+		 */
+		explicit EventPoolResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+			:std::pmr::synchronized_pool_resource(EventPoolOptions(), upstream)
+		{}
+	};
+
+	/**
+	 * @brief 线程安全的单调分配资源，释放操作不回收内存，析构时整体释放
+	 *
+	 * 适用于启动后不再变化的订阅关系等只增不减的数据
+	 */
+	class EventArenaResource : public std::pmr::memory_resource
+	{
+	public:
+		/**
+		 * @brief 构造函数
+		 *
+		 * @param initial_size 首块内存的字节数
+		 * @param upstream 上游资源
+		 */
+		explicit EventArenaResource(size_t initial_size = 1 << 20, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+			:arena(initial_size, upstream)
+		{}
+		/**
+		 * @brief 释放所有已分配的内存，需确保其中的对象均已销毁
+		 */
+		void Release()
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			arena.release();
+		}
+	protected:
+		virtual void* do_allocate(size_t bytes, size_t alignment)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			return arena.allocate(bytes, alignment);
+		}
+		virtual void do_deallocate(void* /*p*/, size_t /*bytes*/, size_t /*alignment*/)
+		{}
+		virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept
+		{
+			return this == &other;
+		}
+	private:
+		std::pmr::monotonic_buffer_resource arena;	//< 单调分配资源
+		std::mutex mtx;								//< 互斥锁
+	};
+
+	/**
+	 * @brief 统计经过的分配次数与字节数并转发至上游资源，用于确认热路径不再分配内存
+	 */
+	class CountingResource : public std::pmr::memory_resource
+	{
+	public:
+		/**
+		 * @brief 构造函数
+		 *
+		 * @param _upstream 上游资源
+		 */
+		explicit CountingResource(std::pmr::memory_resource* _upstream = std::pmr::get_default_resource()) :upstream(_upstream)
+		{}
+		/**
+		 * @brief 获取分配次数
+		 */
+		unsigned long long Allocations() const
+		{
+			return allocations.load(std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 获取当前占用的字节数
+		 */
+		long long BytesInUse() const
+		{
+			return bytes_in_use.load(std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 清零分配次数
+		 */
+		void Reset()
+		{
+			allocations.store(0, std::memory_order_relaxed);
+		}
+	protected:
+		virtual void* do_allocate(size_t bytes, size_t alignment)
+		{
+			allocations.fetch_add(1, std::memory_order_relaxed);
+			bytes_in_use.fetch_add((long long)bytes, std::memory_order_relaxed);
+			return upstream->allocate(bytes, alignment);
+		}
+		virtual void do_deallocate(void* p, size_t bytes, size_t alignment)
+		{
+			bytes_in_use.fetch_sub((long long)bytes, std::memory_order_relaxed);
+			upstream->deallocate(p, bytes, alignment);
+		}
+		virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept
+		{
+			return this == &other;
+		}
+	private:
+		std::pmr::memory_resource* upstream;				//< 上游资源
+		std::atomic<unsigned long long> allocations{ 0 };	//< 分配次数
+		std::atomic<long long> bytes_in_use{ 0 };			//< 当前占用的字节数
+	};
+
+	/**
+	 * @brief 将pmr容器的内容迁移至新的内存资源
+	 *
+	 * 容器的分配器在赋值与交换时不随之传播，因此以分配器扩展的移动构造迁移元素后原地重建容器
+	 * @param container 容器
+	 * @param resource 新的内存资源
+	 */
+	template<typename Container>
+	void RebindResource(Container& container, std::pmr::memory_resource* resource)
+	{
+		Container moved(std::move(container), typename Container::allocator_type(resource));
+		container.~Container();
+		new (&container) Container(std::move(moved));
+	}
+}
\ No newline at end of file
@@ -1,119 +1,935 @@
 #pragma once
 /*****************************************************************//**
  * \file   TanmiEventHandler.hpp
- * \brief  첽¼
+ * \brief  异步事件处理器
  * 
  * \author tanmika
  * \date   April 2023
  *********************************************************************/
+#include <iostream>
+#include <exception>
+#include <chrono>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <functional>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif // __linux__
 #include "TanmiMessageQuene.hpp"
 #include "TanmiListener.hpp"
+#include "TanmiMetrics.hpp"
+#include "TanmiTrace.hpp"
+#include "TanmiLaunchConfig.hpp"
 
 namespace TanmiEngine
 {
+	using MessageClock = std::chrono::steady_clock;	///< 消息计时使用的时钟
+
+	/**
+	 * @brief 消息处理器异常基类。
+	 */
+	class MessageHandlerException : public std::exception
+	{
+	public:
+		virtual const char* what() const throw ()
+		{
+			return "::Expection Message Handler Exception basic";
+		}
+	};
+	/**
+	 * @brief 消息处理器析构时处理线程仍在运行异常类。
+	 */
+	class MessageHandlerStillRunningException : public MessageHandlerException
+	{
+	public:
+		virtual const char* what() const throw ()
+		{
+			return "::Expection handler_still_running, call Shutdown() before releasing the handler";
+		}
+	};
+
+	/**
+	 * @brief 处理线程在自身中调用 Join 而被分离后，由该线程持有的处理器引用，Run 返回后释放
+	 */
+	inline std::shared_ptr<void>& DetachedHandlerRef()
+	{
+		thread_local std::shared_ptr<void> self;
+		return self;
+	}
+
 	/**
-	 * @brief ¼
+	 * @brief 一次追踪触发的完成状态，由该次触发产生的所有消息共享
 	 */
-	class MessageHandler
+	class TriggerCompletion
 	{
 	public:
-		MessageHandler() = default;		//<	ĬϹ캯
-		~MessageHandler() = default;	//<	Ĭ
 		/**
-		* @brief ¼
-		* 
-		* @param id ¼ID
-		* @param cilent 
-		*/
-		virtual void Post(EventID id, std::shared_ptr<Listener> cilent)
+		 * @brief 构造函数
+		 *
+		 * @param count 待处理的消息数量
+		 */
+		explicit TriggerCompletion(int count) :remaining(count)
+		{}
+		/**
+		 * @brief 标记一条消息处理完毕，最后一条消息完成时唤醒等待者并调用后续回调
+		 */
+		void Done()
+		{
+			if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+				return;
+			std::function<void()> callback;
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				done = true;
+				callback = std::move(continuation);
+			}
+			cv.notify_all();
+			if (callback)
+				callback();
+		}
+		/**
+		 * @brief 是否所有消息均已处理
+		 */
+		bool IsDone() const
+		{
+			return remaining.load(std::memory_order_acquire) <= 0;
+		}
+		/**
+		 * @brief 阻塞直至所有消息处理完毕
+		 */
+		void Wait()
+		{
+			if (IsDone())
+				return;
+			std::unique_lock<std::mutex> lock(mtx);
+			cv.wait(lock, [this]()
+				{
+					return done;
+				});
+		}
+		/**
+		 * @brief 阻塞直至所有消息处理完毕或超时
+		 *
+		 * @param timeout 超时时长
+		 * @return true 已完成
+		 * @return false 超时
+		 */
+		template<typename Rep, typename Period>
+		bool WaitFor(const std::chrono::duration<Rep, Period>& timeout)
+		{
+			if (IsDone())
+				return true;
+			std::unique_lock<std::mutex> lock(mtx);
+			return cv.wait_for(lock, timeout, [this]()
+				{
+					return done;
+				});
+		}
+		/**
+		 * @brief 设置完成后的回调，已完成时立即在调用线程中执行
+		 *
+		 * @param callback 回调函数，在处理最后一条消息的线程中执行
+		 */
+		void Then(std::function<void()> callback)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				if (done == false && remaining.load(std::memory_order_acquire) > 0)
+				{
+					continuation = std::move(callback);
+					return;
+				}
+			}
+			callback();
+		}
+	private:
+		std::atomic<int> remaining;			//< 待处理的消息数量
+		bool done = false;					//< 是否已完成，由mtx保护
+		std::function<void()> continuation;	//< 完成后的回调
+		std::mutex mtx;						//< 互斥锁，仅在等待与完成时使用
+		std::condition_variable cv;			//< 完成通知
+	};
+
+	/**
+	 * @brief 追踪触发的句柄，可等待该次触发的所有监听器处理完毕
+	 *
+	 * 句柄可拷贝，空句柄与无监听器的触发均视为已完成
+	 */
+	class TriggerHandle
+	{
+	public:
+		TriggerHandle() = default;
+		explicit TriggerHandle(std::shared_ptr<TriggerCompletion> _completion) :completion(std::move(_completion))
+		{}
+		/**
+		 * @brief 阻塞直至所有监听器处理完毕
+		 */
+		void wait() const
+		{
+			if (completion)
+				completion->Wait();
+		}
+		/**
+		 * @brief 阻塞直至所有监听器处理完毕或超时
+		 *
+		 * @param timeout 超时时长
+		 * @return true 已完成
+		 * @return false 超时
+		 */
+		template<typename Rep, typename Period>
+		bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const
+		{
+			return completion == nullptr || completion->WaitFor(timeout);
+		}
+		/**
+		 * @brief 是否所有监听器均已处理完毕
+		 */
+		bool is_done() const
+		{
+			return completion == nullptr || completion->IsDone();
+		}
+		/**
+		 * @brief 设置完成后的回调，已完成时立即在调用线程中执行，否则在处理最后一条消息的线程中执行
+		 *
+		 * @param callback 回调函数
+		 */
+		void then(std::function<void()> callback) const
+		{
+			if (completion)
+				completion->Then(std::move(callback));
+			else
+				callback();
+		}
+	private:
+		std::shared_ptr<TriggerCompletion> completion;	//< 完成状态，为空表示无需等待
+	};
+
+	/**
+	 * @brief 消息，一次事件对一个监听器的通知
+	 */
+	struct Message
+	{
+		EventID id = 0;						///< 事件ID
+		std::shared_ptr<Listener> listener{};	///< 监听器
+		double ms = 0;						///< 事件发生所经过的时间（以毫秒为单位）
+		MessageClock::time_point post_time{};	///< 发送时刻
+		std::shared_ptr<TriggerCompletion> completion{};	///< 追踪触发的完成状态，未追踪时为空
+		std::pmr::vector<EventID> batch{};	///< 批量事件ID，非空时为批量消息，id无效；由发送处理器的内存资源分配
+		uint64_t trace_id = 0;				///< 追踪流ID，未定义 TANMI_TRACE 时不使用；始终保留以免布局随宏变化
+	};
+
+	/**
+	 * @brief 消息处理器的公共部分：消息队列、处理线程的生命周期、调用线程中的泵送与处理进度的同步
+	 *
+	 * 派生类通过 deliver / deliverRun 决定消息如何交给监听器
+	 */
+	class MessageHandlerCore : public std::enable_shared_from_this<MessageHandlerCore>
+	{
+	public:
+		MessageHandlerCore() = default;		///< 默认构造函数
+		/**
+		 * @brief 以指定内存资源构造，消息队列的分块由该资源分配
+		 *
+		 * @param resource 内存资源，如 EventPoolResource
+		 */
+		explicit MessageHandlerCore(std::pmr::memory_resource* _resource) :messages(_resource), resource(_resource)
+		{}
+		/**
+		 * @brief 析构函数，关闭eventfd
+		 */
+		virtual ~MessageHandlerCore()
 		{
-			listener.Push(cilent);
-			listener_id.Push(id);
+#ifdef __linux__
+			if (event_fd >= 0)
+				close(event_fd);
+#endif // __linux__
 		}
 		/**
-		 * @brief Ϣ
+		 * @brief 处理消息队列
 		 */
 		virtual void Run()
 		{
-			while (!exit)
+			Message message{ .batch = std::pmr::vector<EventID>(resource) };
+			std::vector<Message> run;
+			while (!exit.load(std::memory_order_acquire))
+			{
+				size_t limit = batch_limit.load(std::memory_order_relaxed);
+				if (limit > 1)
+				{
+					if (messages.PopRun(run, limit, isSameRun, true) == false)
+						break;
+					dispatchRun(run);
+					run.clear();
+				}
+				else
+				{
+					if (messages.Pop(message) == false)
+						break;
+					dispatch(message);
+				}
+			}
+		}
+		/**
+		 * @brief 设置连续消息的合并投递
+		 *
+		 * 队列中连续发往同一监听器的消息合并为一次 HandleMessageBatch 调用，减少逐条虚函数调用与出队开销
+		 * @param max_run 单次合并的最大消息数量，为1时关闭
+		 */
+		void SetBatchDelivery(size_t max_run)
+		{
+			batch_limit.store(max_run < 1 ? 1 : max_run, std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 获取单次合并的最大消息数量
+		 */
+		size_t GetBatchDelivery() const
+		{
+			return batch_limit.load(std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 设置处理线程在队列为空时的等待策略
+		 *
+		 * 自旋期间到达的消息无需唤醒处理线程，适用于消息间隔短于一次休眠唤醒的场景；自旋会占用处理线程所在的CPU
+		 * @param policy 等待策略
+		 */
+		void SetWaitPolicy(const QueueWaitPolicy& policy)
+		{
+			messages.SetWaitPolicy(policy);
+		}
+		/**
+		 * @brief 获取等待策略
+		 */
+		QueueWaitPolicy GetWaitPolicy()
+		{
+			return messages.GetWaitPolicy();
+		}
+		/**
+		 * @brief 获取运行指标快照（需定义 TANMI_METRICS，否则为空快照）
+		 *
+		 * @return HandlerMetricsSnapshot 指标快照
+		 */
+		HandlerMetricsSnapshot GetMetrics() const
+		{
+#ifdef TANMI_METRICS
+			return metrics.Snapshot();
+#else
+			return HandlerMetricsSnapshot();
+#endif // TANMI_METRICS
+		}
+		/**
+		 * @brief 清空运行指标
+		 */
+		void ResetMetrics()
+		{
+			TANMI_METRIC(metrics.Reset());
+		}
+		/**
+		* @brief 关闭消息处理器
+		*/
+		void Exit()
+		{
+			exit.store(true, std::memory_order_release);
+			messages.Stop();
+		}
+		/**
+		 * @brief 设置启动配置，在下次启动处理线程时生效
+		 *
+		 * @param config 启动配置
+		 */
+		void SetLaunchConfig(const HandlerLaunchConfig& config)
+		{
+			std::lock_guard<std::mutex> lock(lifecycle);
+			launch = config;
+		}
+		/**
+		 * @brief 获取启动配置
+		 */
+		HandlerLaunchConfig GetLaunchConfig() const
+		{
+			std::lock_guard<std::mutex> lock(lifecycle);
+			return launch;
+		}
+		/**
+		 * @brief 按启动配置启动处理线程，已启动时无效果
+		 */
+		void Start()
+		{
+			std::lock_guard<std::mutex> lock(lifecycle);
+			if (running.load(std::memory_order_relaxed))
+				return;
+			exit.store(false, std::memory_order_release);
+			messages.Resume();
+			size_t count = launch.workers < 1 ? 1 : launch.workers;
+			for (size_t i = 0; i < count; ++i)
+			{
+				workers.emplace_back([this, i, config = launch]()
+					{
+						ApplyLaunchConfig(config, i);
+						Run();
+						// 已被分离时释放自身持有的引用，处理器可能随之析构，此后不可访问成员
+						DetachedHandlerRef().reset();
+					});
+			}
+			running.store(true, std::memory_order_release);
+		}
+		/**
+		 * @brief 等待处理线程退出，需先调用 Exit
+		 *
+		 * 在处理线程自身中调用时改为分离该线程，该线程持有处理器的引用直至 Run 返回，
+		 * 因此调用者随后释放处理器（如在监听器中更换消息处理器）不会使其访问已销毁的对象
+		 */
+		void Join()
+		{
+			std::vector<std::thread> stopping;
+			{
+				std::lock_guard<std::mutex> lock(lifecycle);
+				stopping.swap(workers);
+				running.store(false, std::memory_order_release);
+			}
+			for (auto& worker : stopping)
 			{
-				HandleMessage(listener_id.Pop(), std::move(listener.Pop()));
+				if (worker.get_id() == std::this_thread::get_id())
+				{
+					DetachedHandlerRef() = weak_from_this().lock();
+					worker.detach();
+				}
+				else
+					worker.join();
 			}
 		}
 		/**
-		* @brief Ϣ
+		 * @brief 是否已启动处理线程
+		 */
+		bool IsRunning() const
+		{
+			return running.load(std::memory_order_acquire);
+		}
+		/**
+		 * @brief 阻塞直至调用前已发送的消息全部处理完毕
+		 *
+		 * 未启动处理线程时在调用线程中处理消息；不可在处理线程中调用
+		 */
+		void Flush()
+		{
+			waitProcessed(posted.load(std::memory_order_acquire));
+		}
+		/**
+		 * @brief 阻塞直至队列为空且没有正在处理的消息，包括等待期间新发送的消息
+		 *
+		 * 未启动处理线程时在调用线程中处理消息；不可在处理线程中调用
+		 */
+		void WaitIdle()
+		{
+			unsigned long long target;
+			do
+			{
+				target = posted.load(std::memory_order_acquire);
+				waitProcessed(target);
+			} while (posted.load(std::memory_order_acquire) != target);
+		}
+		/**
+		 * @brief 关闭消息处理器并回收处理线程
+		 *
+		 * @param drain 是否先处理完所有积压的消息，为false时积压消息保留在队列中
+		 */
+		void Shutdown(bool drain = true)
+		{
+			if (drain)
+				WaitIdle();
+			Exit();
+			Join();
+		}
+		/**
+		 * @brief 获取积压的消息数量
+		 *
+		 * @return size_t 消息数量
+		 */
+		size_t GetBacklog()
+		{
+			return messages.Size();
+		}
+		/**
+		 * @brief 获取最早一条积压消息已等待的时长
+		 *
+		 * @return double 等待时长（以毫秒为单位），无积压时为0
+		 */
+		double GetBacklogAge()
+		{
+			MessageClock::time_point post_time{};
+			if (messages.PeekFront([&](const Message& front) { post_time = front.post_time; }) == false)
+				return 0;
+			return std::chrono::duration<double, std::milli>(MessageClock::now() - post_time).count();
+		}
+		/**
+		 * @brief 在调用线程中处理当前积压的所有消息，不阻塞
+		 *
+		 * 用于未启动处理线程的消息处理器，由外部事件循环驱动
+		 * @return size_t 处理的消息数量
+		 */
+		size_t Poll()
+		{
+			return pump((std::numeric_limits<size_t>::max)(), MessageClock::time_point::max());
+		}
+		/**
+		 * @brief 在调用线程中处理至多 max_messages 条消息，不阻塞
+		 *
+		 * 未处理的消息留在队列中，等待下次调用
+		 * @param max_messages 最多处理的消息数量
+		 * @return size_t 处理的消息数量
+		 */
+		size_t Pump(size_t max_messages)
+		{
+			return pump(max_messages, MessageClock::time_point::max());
+		}
+		/**
+		 * @brief 在调用线程中于时间预算内处理消息，不阻塞
+		 *
+		 * 每处理一条消息后检查预算，超出预算时停止，未处理的消息留在队列中等待下次调用
+		 * @param budget 时间预算
+		 * @param max_messages 最多处理的消息数量
+		 * @return size_t 处理的消息数量
+		 */
+		size_t PumpFor(MessageClock::duration budget, size_t max_messages = (std::numeric_limits<size_t>::max)())
+		{
+			return pump(max_messages, MessageClock::now() + budget);
+		}
+#ifdef __linux__
+		/**
+		 * @brief 获取消息到达通知的eventfd，首次调用时创建
+		 *
+		 * 发送消息时eventfd变为可读，可与其他描述符一同加入epoll等待，可读时调用Poll处理
+		 * @return int eventfd，创建失败时为-1
+		 */
+		int GetEventFd()
+		{
+			int fd = event_fd.load(std::memory_order_acquire);
+			if (fd >= 0)
+				return fd;
+			int created = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (created < 0)
+				return -1;
+			if (event_fd.compare_exchange_strong(fd, created, std::memory_order_acq_rel) == false)
+			{
+				close(created);
+				return fd;
+			}
+			return created;
+		}
+#endif // __linux__
+	protected:
+		/**
+		 * @brief 将一条消息交给监听器
+		 */
+		virtual void deliver(Message& message) = 0;
+		/**
+		 * @brief 将发往同一监听器的连续消息以一次批量调用交给监听器
+		 */
+		virtual void deliverRun(std::vector<Message>& run) = 0;
+		/**
+		 * @brief 析构时的兜底：处理线程仍在运行时输出异常信息并停止处理线程，由派生类析构函数调用
+		 *
+		 * 处理线程须由持有者在释放最后一个引用前通过 Shutdown（或 Exit 与 Join）停止：
+		 * 派生类部分先于基类析构，此时处理线程可能仍在执行其虚函数
+		 * @param where 输出异常信息时的函数名
+		 */
+		void stopOnDestroy(const char* where)
+		{
+			try
+			{
+				if (running.load(std::memory_order_acquire))
+					throw MessageHandlerStillRunningException();
+			}
+			catch (MessageHandlerException& e)
+			{
+				std::cout << "\n" << where << e.what() << std::endl;
+				Exit();
+				Join();
+			}
+		}
+		/**
+		 * @brief 将积压的消息按原顺序迁移至另一消息处理器，排在其已有消息之前
+		 */
+		size_t migrateTo(MessageHandlerCore& other)
+		{
+			std::vector<Message> pending;
+			size_t count = messages.TakeAll(pending);
+			if (count == 0)
+				return 0;
+			other.posted.fetch_add(count, std::memory_order_relaxed);
+			other.messages.PushFront(pending);
+			other.notifyEventFd();
+			processed.fetch_add(count, std::memory_order_release);
+			processed.notify_all();
+			return count;
+		}
+		/**
+		 * @brief 将消息推入队列并通知
+		 */
+		void push(Message&& message)
+		{
+			posted.fetch_add(1, std::memory_order_relaxed);
+			TANMI_TRACE_POINT(if (Tracer::Instance().IsEnabled())
+			{
+				message.trace_id = Tracer::NewFlowId();
+				Tracer::Record(TraceType::Post, message.id, message.trace_id);
+			});
+			[[maybe_unused]] size_t depth = messages.Push(std::move(message));
+			TANMI_METRIC(metrics.RecordPost(depth));
+			notifyEventFd();
+		}
+		/**
+		 * @brief 通知eventfd有新消息
+		 */
+		void notifyEventFd()
+		{
+#ifdef __linux__
+			int fd = event_fd.load(std::memory_order_acquire);
+			if (fd >= 0)
+				eventfd_write(fd, 1);
+#endif // __linux__
+		}
+		/**
+		 * @brief 处理一条消息
+		 */
+		void dispatch(Message& message)
+		{
+			TANMI_METRIC(metrics.RecordWake(message.post_time, MessageClock::now()));
+			TANMI_TRACE_POINT(TraceScope trace_scope(TraceType::ListenerBegin, TraceType::ListenerEnd, message.id);
+				Tracer::Record(TraceType::Dequeue, message.id, message.trace_id));
+			deliver(message);
+			complete(message);
+		}
+		/**
+		 * @brief 以一次批量调用处理发往同一监听器的连续消息
+		 */
+		void dispatchRun(std::vector<Message>& run)
+		{
+			if (run.size() == 1)
+			{
+				dispatch(run.front());
+				return;
+			}
+			TANMI_METRIC(auto start = MessageClock::now();
+				for (auto& message : run)
+					metrics.RecordWake(message.post_time, start));
+			TANMI_TRACE_POINT(TraceScope trace_scope(TraceType::ListenerBegin, TraceType::ListenerEnd, run.front().id);
+				for (auto& message : run)
+					Tracer::Record(TraceType::Dequeue, message.id, message.trace_id));
+			deliverRun(run);
+			for (auto& message : run)
+			{
+				if (message.completion)
+					message.completion->Done();
+			}
+			processed.fetch_add(run.size(), std::memory_order_seq_cst);
+			notifyProcessed();
+		}
+		/**
+		 * @brief 两条消息能否合并投递，批量消息不参与合并
+		 */
+		static bool isSameRun(const Message& first, const Message& next)
+		{
+			return first.listener == next.listener && first.batch.empty() && next.batch.empty();
+		}
+		/**
+		 * @brief 一条消息处理完毕，更新完成状态与处理计数
+		 */
+		void complete(Message& message)
+		{
+			if (message.completion)
+				message.completion->Done();
+			processed.fetch_add(1, std::memory_order_seq_cst);
+			notifyProcessed();
+		}
+		/**
+		 * @brief 阻塞直至已处理的消息数量达到 target
+		 */
+		void waitProcessed(unsigned long long target)
+		{
+			if (running.load(std::memory_order_acquire) == false)
+			{
+				// 无处理线程时由调用线程处理
+				while (processed.load(std::memory_order_acquire) < target && Poll() != 0);
+			}
+			waiters.fetch_add(1, std::memory_order_seq_cst);
+			unsigned long long cur;
+			while ((cur = processed.load(std::memory_order_seq_cst)) < target)
+				processed.wait(cur, std::memory_order_acquire);
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 唤醒等待处理计数的线程，无等待者时跳过
+		 */
+		void notifyProcessed()
+		{
+			if (waiters.load(std::memory_order_seq_cst) != 0)
+				processed.notify_all();
+		}
+		/**
+		 * @brief 在调用线程中处理消息，直至达到数量上限、截止时刻或队列为空
+		 *
+		 * @param max_messages 最多处理的消息数量
+		 * @param deadline 截止时刻
+		 * @return size_t 处理的消息数量
+		 */
+		size_t pump(size_t max_messages, MessageClock::time_point deadline)
+		{
+#ifdef __linux__
+			int fd = event_fd.load(std::memory_order_acquire);
+			if (fd >= 0)
+			{
+				// 先清空计数，此后发送的消息会重新唤醒
+				eventfd_t value;
+				eventfd_read(fd, &value);
+			}
+#endif // __linux__
+			size_t count = 0;
+			// 接收消息的对象与批量事件使用同一资源，出队时的移动赋值不再重新分配
+			Message message{ .batch = std::pmr::vector<EventID>(resource) };
+			thread_local std::vector<Message> run;
+			while (count < max_messages)
+			{
+				size_t limit = (std::min)(batch_limit.load(std::memory_order_relaxed), max_messages - count);
+				if (limit > 1)
+				{
+					if (messages.PopRun(run, limit, isSameRun, false) == false)
+						break;
+					count += run.size();
+					dispatchRun(run);
+					run.clear();
+				}
+				else
+				{
+					if (messages.TryPop(message) == false)
+						break;
+					dispatch(message);
+					++count;
+				}
+				if (deadline != MessageClock::time_point::max() && MessageClock::now() >= deadline)
+					break;
+			}
+#ifdef __linux__
+			// 仍有积压时保持eventfd可读
+			if (fd >= 0 && messages.Size() != 0)
+				notifyEventFd();
+#endif // __linux__
+			return count;
+		}
+		MessageQueue<Message> messages;	///< 消息队列
+		std::atomic<bool> exit{ false };	///< 是否退出
+		std::atomic<int> event_fd{ -1 };	///< 消息到达通知的eventfd
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource();	///< 队列分块与批量事件使用的内存资源
+		mutable std::mutex lifecycle;		///< 保护处理线程列表与启动配置
+		std::vector<std::thread> workers;	///< 处理线程，由lifecycle保护
+		std::atomic<bool> running{ false };	///< 是否已启动处理线程
+		HandlerLaunchConfig launch;			///< 启动配置，由lifecycle保护
+		std::atomic<unsigned long long> posted{ 0 };	///< 已发送的消息数量
+		std::atomic<unsigned long long> processed{ 0 };	///< 已处理的消息数量
+		std::atomic<size_t> batch_limit{ 1 };			///< 单次合并的最大消息数量
+		std::atomic<int> waiters{ 0 };					///< 等待处理计数的线程数量
+#ifdef TANMI_METRICS
+		HandlerMetrics metrics;							///< 运行指标
+#endif // TANMI_METRICS
+	};
+
+	/**
+	 * @brief 事件处理基类
+	 */
+	class MessageHandler : public MessageHandlerCore
+	{
+	public:
+		MessageHandler() = default;		//<	默认构造函数
+		/**
+		 * @brief 以指定内存资源构造，消息队列的分块由该资源分配
+		 *
+		 * @param resource 内存资源，如 EventPoolResource
+		 */
+		explicit MessageHandler(std::pmr::memory_resource* resource) :MessageHandlerCore(resource)
+		{}
+		/**
+		 * @brief 析构函数，处理线程仍在运行时输出异常信息，并作为兜底停止处理线程
+		 */
+		~MessageHandler()
+		{
+			stopOnDestroy("::~MessageHandler()");
+		}
+		/**
+		* @brief 发送事件
+		* 
+		* @param id 事件ID
+		* @param cilent 监听器
+		*/
+		virtual void Post(EventID id, std::shared_ptr<Listener> cilent)
+		{
+			push(Message{ id, std::move(cilent), 0, MessageClock::now() });
+		}
+		/**
+		* @brief 发送追踪的事件，处理完毕后标记完成状态
+		* 
+		* @param id 事件ID
+		* @param cilent 监听器
+		* @param completion 完成状态
+		*/
+		virtual void Post(EventID id, std::shared_ptr<Listener> cilent, std::shared_ptr<TriggerCompletion> completion)
+		{
+			push(Message{ id, std::move(cilent), 0, MessageClock::now(), std::move(completion) });
+		}
+		/**
+		* @brief 发送批量事件，监听器以一次 WakeEventBatch 接收
 		* 
-		* @param id ¼ID
-		* @param message 
+		* @param cilent 监听器
+		* @param events 事件ID列表
+		*/
+		virtual void PostBatch(std::shared_ptr<Listener> cilent, std::span<const EventID> events)
+		{
+			push(Message{ 0, std::move(cilent), 0, MessageClock::now(), nullptr, std::pmr::vector<EventID>(events.begin(), events.end(), resource) });
+		}
+		/**
+		* @brief 处理消息
+		* 
+		* @param id 事件ID
+		* @param message 监听器
 		*/
 		virtual void HandleMessage(const EventID id, std::shared_ptr<Listener> message)
 		{
 			message->WakeEvent(id);
 		}
 		/**
-		* @brief رϢ
+		* @brief 处理批量消息
+		* 
+		* @param message 监听器
+		* @param events 事件ID列表
 		*/
-		void Exit()
+		virtual void HandleMessageBatch(std::shared_ptr<Listener> message, std::span<const EventID> events)
 		{
-			exit = true;
+			message->WakeEventBatch(events);
+		}
+		/**
+		 * @brief 将积压的消息按原顺序迁移至另一消息处理器，排在其已有消息之前
+		 *
+		 * 需在本处理器停止后调用
+		 * @param other 目标消息处理器
+		 * @return size_t 迁移的消息数量
+		 */
+		size_t MigrateTo(MessageHandler& other)
+		{
+			return migrateTo(other);
 		}
 	protected:
-		MessageQueue<std::shared_ptr<Listener>> listener;	///< 
-		MessageQueue<EventID> listener_id;					///< ¼ID
-		bool exit = false;									///< Ƿ˳
+		virtual void deliver(Message& message)
+		{
+			if (message.batch.empty())
+				HandleMessage(message.id, std::move(message.listener));
+			else
+				HandleMessageBatch(std::move(message.listener), message.batch);
+		}
+		virtual void deliverRun(std::vector<Message>& run)
+		{
+			thread_local std::vector<EventID> events;
+			events.clear();
+			for (auto& message : run)
+				events.push_back(message.id);
+			HandleMessageBatch(run.front().listener, events);
+		}
 	};
 	/**
-	 * @brief ¼ࣨʱ
+	 * @brief 事件处理基类（带有时间参数）
 	 */
-	class MessageHandlerUpdate
+	class MessageHandlerUpdate : public MessageHandlerCore
 	{
 	public:
-		MessageHandlerUpdate() = default;	//<	ĬϹ캯
-		~MessageHandlerUpdate() = default;	//<	Ĭ
+		MessageHandlerUpdate() = default;	//<	默认构造函数
 		/**
-		* @brief ¼
+		 * @brief 以指定内存资源构造，消息队列的分块由该资源分配
+		 *
+		 * @param resource 内存资源，如 EventPoolResource
+		 */
+		explicit MessageHandlerUpdate(std::pmr::memory_resource* resource) :MessageHandlerCore(resource)
+		{}
+		/**
+		 * @brief 析构函数，处理线程仍在运行时输出异常信息，并作为兜底停止处理线程
+		 */
+		~MessageHandlerUpdate()
+		{
+			stopOnDestroy("::~MessageHandlerUpdate()");
+		}
+		/**
+		* @brief 发送事件
 		* 
-		* @param id ¼ID
-		* @param cilent 
-		* @param ms ¼ʱ䣨ԺΪλ
+		* @param id 事件ID
+		* @param cilent 监听器
+		* @param ms 事件发生所经过的时间（以毫秒为单位）
 		*/
 		virtual void Post(EventID id, std::shared_ptr<Listener> cilent, double ms)
 		{
-			listener.Push(cilent);
-			listener_id.Push(id);
-			listener_t.Push(ms);
+			push(Message{ id, std::move(cilent), ms, MessageClock::now() });
 		}
 		/**
-		* @brief Ϣ
+		* @brief 发送追踪的事件，处理完毕后标记完成状态
+		* 
+		* @param id 事件ID
+		* @param cilent 监听器
+		* @param ms 事件发生所经过的时间（以毫秒为单位）
+		* @param completion 完成状态
 		*/
-		virtual void Run()
+		virtual void Post(EventID id, std::shared_ptr<Listener> cilent, double ms, std::shared_ptr<TriggerCompletion> completion)
 		{
-			while (!exit)
-			{
-				HandleMessage(listener_id.Pop(), std::move(listener.Pop()), listener_t.Pop());
-			}
+			push(Message{ id, std::move(cilent), ms, MessageClock::now(), std::move(completion) });
 		}
-        /* @brief Ϣ
+        /* @brief 处理消息
 		* 
-		* @param id ¼ID
-		* @param message 
-		* @param ms ¼ʱ䣨ԺΪλ
+		* @param id 事件ID
+		* @param message 监听器
+		* @param ms 事件发生所经过的时间（以毫秒为单位）
 		*/
 		virtual void HandleMessage(const EventID id, std::shared_ptr<Listener> message, double time)
 		{
 			message->WakeEventUpdate(id, time);
 		}
 		/**
-		 * @brief رϢ
+		* @brief 处理发往同一监听器的连续消息
+		* 
+		* @param message 监听器
+		* @param events 事件ID列表
+		* @param ms 与events一一对应的事件发生所经过的时间（以毫秒为单位）
+		*/
+		virtual void HandleMessageBatch(std::shared_ptr<Listener> message, std::span<const EventID> events, std::span<const double> ms)
+		{
+			message->WakeEventUpdateBatch(events, ms);
+		}
+		/**
+		 * @brief 将积压的消息按原顺序迁移至另一消息处理器，排在其已有消息之前
+		 *
+		 * 需在本处理器停止后调用
+		 * @param other 目标消息处理器
+		 * @return size_t 迁移的消息数量
 		 */
-		void Exit()
+		size_t MigrateTo(MessageHandlerUpdate& other)
 		{
-			exit = true;
+			return migrateTo(other);
 		}
 	protected:
-		MessageQueue<std::shared_ptr<Listener>> listener;	//<	
-		MessageQueue<EventID> listener_id;					//<	¼ID
-		MessageQueue<double> listener_t;					//<	¼ʱ䣨ԺΪλ
-		bool exit = false;									//<	Ƿ˳
+		virtual void deliver(Message& message)
+		{
+			HandleMessage(message.id, std::move(message.listener), message.ms);
+		}
+		virtual void deliverRun(std::vector<Message>& run)
+		{
+			thread_local std::vector<EventID> events;
+			thread_local std::vector<double> ms;
+			events.clear();
+			ms.clear();
+			for (auto& message : run)
+			{
+				events.push_back(message.id);
+				ms.push_back(message.ms);
+			}
+			HandleMessageBatch(run.front().listener, events, ms);
+		}
 	};
-}
\ No newline at end of file
+}
@@ -1,62 +1,356 @@
 #pragma once
 /*****************************************************************//**
  * \file   TanmiMessageQuene.hpp
- * \brief  ¼
+ * \brief  事件队列
  * 
  * \author tanmika
  * \date   April 2023
  *********************************************************************/
-#include <queue>
+#include <algorithm>
+#include <deque>
+#include <memory_resource>
+#include <iterator>
+#include <vector>
 #include <mutex>
+#include <atomic>
+#include <thread>
 #include <condition_variable>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
 #include "TanmiEvent.hpp"
 
 using EventID = int;
 namespace TanmiEngine {
 	/**
-	* @brief ڴ洢ʹTϢ
+	 * @brief 自旋等待时提示处理器降低功耗并让出流水线
+	 */
+	inline void CpuRelax()
+	{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+		_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+		asm volatile("yield");
+#endif
+	}
+
+	/**
+	 * @brief 队列为空时消费者的等待策略：先自旋，再让出时间片，最后休眠于条件变量
+	 */
+	struct QueueWaitPolicy
+	{
+		size_t spin = 0;		///< 自旋次数，开启自适应时为上限
+		size_t yield = 0;		///< 让出时间片的次数
+		bool adaptive = false;	///< 是否自适应调整自旋次数：自旋期间等到消息时延长，需要休眠时缩短
+	};
+	/**
+	* @brief 用于存储和处理类型T的消息队列
 	*
-	* @tparam T Ԫص
+	* @tparam T 队列中元素的类型
 	*/
 	template<typename T>
 	class MessageQueue
 	{
 	public:
 		/*
-		* @brief ĬϹ캯
+		* @brief 默认构造函数
 		*/
 		MessageQueue() = default;
 		/**
-		 * @brief ϢT
+		 * @brief 以指定内存资源构造，队列的分块由该资源分配
 		 *
-		 * @param message ҪеϢ
+		 * @param resource 内存资源
 		 */
-		void Push(T& message)
+		explicit MessageQueue(std::pmr::memory_resource* resource) :queue_(resource)
+		{}
+		/**
+		 * @brief 将消息T推入队列
+		 *
+		 * @param message 要推入队列的消息引用
+		 * @return size_t 推入后的队列长度
+		 */
+		size_t Push(T& message)
 		{
 			std::lock_guard<std::mutex> lock(mutex_);
-			queue_.push(message);
-			cv_.notify_one();
+			queue_.push_back(message);
+			count_.store(queue_.size(), std::memory_order_relaxed);
+			// 仅在有消费者休眠时发起唤醒
+			if (parked_ != 0)
+				cv_.notify_one();
+			return queue_.size();
 		}
 		/**
-		 * @brief ӶȡһϢT䵯
+		 * @brief 将消息T移入队列
 		 *
-		 * @return T Ϣ
+		 * @param message 要移入队列的消息对象
+		 * @return size_t 推入后的队列长度
+		 */
+		size_t Push(T&& message)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			queue_.push_back(std::move(message));
+			count_.store(queue_.size(), std::memory_order_relaxed);
+			// 仅在有消费者休眠时发起唤醒
+			if (parked_ != 0)
+				cv_.notify_one();
+			return queue_.size();
+		}
+		/**
+		 * @brief 从队列中取出下一个消息T并将其弹出队列
+		 *
+		 * @return T 弹出的消息
 		 */
 		T Pop()
 		{
+			spinWait();
 			std::unique_lock<std::mutex> lock(mutex_);
-			cv_.wait(lock, [this]()
-				{
-					return !queue_.empty();
-				});
+			park(lock, false);
 			T message = std::move(queue_.front());
-			queue_.pop();
+			queue_.pop_front();
+			count_.store(queue_.size(), std::memory_order_relaxed);
 			return message;
 		}
+		/**
+		 * @brief 从队列中取出下一个消息T，队列为空时阻塞，直至有新消息或队列被停止
+		 *
+		 * @param message 用于接收取出的消息
+		 * @return true 成功取出
+		 * @return false 队列已停止，剩余消息保留在队列中
+		 */
+		bool Pop(T& message)
+		{
+			spinWait();
+			std::unique_lock<std::mutex> lock(mutex_);
+			park(lock, true);
+			if (stopped_)
+				return false;
+			message = std::move(queue_.front());
+			queue_.pop_front();
+			count_.store(queue_.size(), std::memory_order_relaxed);
+			return true;
+		}
+		/**
+		 * @brief 取出队首消息及其后与之连续同组的消息
+		 *
+		 * @param out 用于接收消息的容器，消息追加至末尾
+		 * @param max_count 最多取出的消息数量
+		 * @param same 判断两条消息是否同组，参数为本次取出的第一条消息与当前队首
+		 * @param wait 队列为空时是否阻塞，直至有新消息或队列被停止
+		 * @return true 成功取出
+		 * @return false 队列为空或已停止
+		 */
+		template<typename Same>
+		bool PopRun(std::vector<T>& out, size_t max_count, Same same, bool wait)
+		{
+			if (wait)
+				spinWait();
+			std::unique_lock<std::mutex> lock(mutex_);
+			if (wait)
+			{
+				park(lock, true);
+				if (stopped_)
+					return false;
+			}
+			else if (queue_.empty())
+				return false;
+			size_t first = out.size();
+			out.push_back(std::move(queue_.front()));
+			queue_.pop_front();
+			while (out.size() - first < max_count && !queue_.empty() && same(out[first], queue_.front()))
+			{
+				out.push_back(std::move(queue_.front()));
+				queue_.pop_front();
+			}
+			count_.store(queue_.size(), std::memory_order_relaxed);
+			return true;
+		}
+		/**
+		 * @brief 停止队列，唤醒所有阻塞在 Pop(T&) 中的线程
+		 */
+		void Stop()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopped_ = true;
+			stopped_flag_.store(true, std::memory_order_relaxed);
+			cv_.notify_all();
+		}
+		/**
+		 * @brief 恢复已停止的队列
+		 */
+		void Resume()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopped_ = false;
+			stopped_flag_.store(false, std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 取出队列中的所有消息
+		 *
+		 * @param out 用于接收消息的容器，消息按队列顺序追加至末尾
+		 * @return size_t 取出的消息数量
+		 */
+		template<typename Container>
+		size_t TakeAll(Container& out)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			size_t count = queue_.size();
+			while (!queue_.empty())
+			{
+				out.push_back(std::move(queue_.front()));
+				queue_.pop_front();
+			}
+			count_.store(0, std::memory_order_relaxed);
+			return count;
+		}
+		/**
+		 * @brief 将一组消息按顺序插入队首，排在所有已有消息之前
+		 *
+		 * @param items 消息容器
+		 */
+		template<typename Container>
+		void PushFront(Container& items)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			queue_.insert(queue_.begin(), std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+			count_.store(queue_.size(), std::memory_order_relaxed);
+			cv_.notify_all();
+		}
+		/**
+		 * @brief 尝试从队列中取出第一个消息T，队列为空时立即返回
+		 *
+		 * @param message 用于接收取出的消息
+		 * @return true 成功取出
+		 * @return false 队列为空
+		 */
+		bool TryPop(T& message)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (queue_.empty())
+				return false;
+			message = std::move(queue_.front());
+			queue_.pop_front();
+			count_.store(queue_.size(), std::memory_order_relaxed);
+			return true;
+		}
+		/**
+		 * @brief 获取队列中的消息数量
+		 *
+		 * @return size_t 消息数量
+		 */
+		size_t Size()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return queue_.size();
+		}
+		/**
+		 * @brief 在队列锁内读取队首消息，不复制、不弹出
+		 *
+		 * @param visit 以队首消息的常量引用调用，不应阻塞或访问本队列
+		 * @return true 队列非空
+		 * @return false 队列为空
+		 */
+		template<typename Visit>
+		bool PeekFront(Visit&& visit)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (queue_.empty())
+				return false;
+			visit(static_cast<const T&>(queue_.front()));
+			return true;
+		}
+
+		/**
+		 * @brief 设置队列为空时的等待策略
+		 *
+		 * @param policy 等待策略
+		 */
+		void SetWaitPolicy(const QueueWaitPolicy& policy)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			policy_ = policy;
+			spin_window_.store(policy.spin, std::memory_order_relaxed);
+			max_spin_.store(policy.spin, std::memory_order_relaxed);
+			yield_count_.store(policy.yield, std::memory_order_relaxed);
+			adaptive_.store(policy.adaptive, std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 获取等待策略
+		 */
+		QueueWaitPolicy GetWaitPolicy()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return policy_;
+		}
+		/**
+		 * @brief 获取当前的自旋次数，开启自适应时随负载变化
+		 */
+		size_t GetSpinWindow() const
+		{
+			return spin_window_.load(std::memory_order_relaxed);
+		}
 
 	private:
-		std::queue<T> queue_;	//< 洢ԪصĶ
-		std::mutex mutex_;		//< 
-		std::condition_variable cv_;	//< 
+		/**
+		 * @brief 不持有锁地自旋与让出时间片，直至队列非空、已停止或次数用尽
+		 */
+		void spinWait()
+		{
+			size_t spin = spin_window_.load(std::memory_order_relaxed);
+			size_t yield = yield_count_.load(std::memory_order_relaxed);
+			if (spin == 0 && yield == 0)
+				return;
+			for (size_t i = 0; i < spin; ++i)
+			{
+				if (ready())
+				{
+					if (adaptive_.load(std::memory_order_relaxed))
+						spin_window_.store((std::min)(spin + spin / 2 + 1, max_spin_.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+					return;
+				}
+				CpuRelax();
+			}
+			for (size_t i = 0; i < yield; ++i)
+			{
+				if (ready())
+					return;
+				std::this_thread::yield();
+			}
+			if (adaptive_.load(std::memory_order_relaxed) && ready() == false)
+				spin_window_.store((std::max)(spin / 2, MIN_ADAPTIVE_SPIN), std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 在持有锁时休眠，直至队列非空（或已停止）
+		 */
+		void park(std::unique_lock<std::mutex>& lock, bool stoppable)
+		{
+			while (queue_.empty() && !(stoppable && stopped_))
+			{
+				++parked_;
+				cv_.wait(lock);
+				--parked_;
+			}
+		}
+		/**
+		 * @brief 不持有锁地判断是否可以结束等待
+		 */
+		bool ready() const
+		{
+			return count_.load(std::memory_order_relaxed) != 0 || stopped_flag_.load(std::memory_order_relaxed);
+		}
+
+		static constexpr size_t MIN_ADAPTIVE_SPIN = 16;	//< 自适应自旋次数的下限
+
+		std::pmr::deque<T> queue_;	//< 存储元素的队列
+		std::mutex mutex_;		//< 互斥锁
+		std::condition_variable cv_;	//< 条件变量
+		bool stopped_ = false;			//< 是否已停止
+		int parked_ = 0;				//< 休眠于条件变量的消费者数量，由互斥锁保护
+		std::atomic<size_t> count_{ 0 };			//< 队列长度，供自旋时无锁读取
+		std::atomic<bool> stopped_flag_{ false };	//< 是否已停止，供自旋时无锁读取
+		QueueWaitPolicy policy_;					//< 等待策略
+		std::atomic<size_t> spin_window_{ 0 };		//< 当前的自旋次数
+		std::atomic<size_t> max_spin_{ 0 };			//< 自旋次数上限
+		std::atomic<size_t> yield_count_{ 0 };		//< 让出时间片的次数
+		std::atomic<bool> adaptive_{ false };		//< 是否自适应
 	};
 }
\ No newline at end of file
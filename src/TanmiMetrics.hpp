@@ -0,0 +1,250 @@
+#pragma once
+/*****************************************************************//**
+ * \file   TanmiMetrics.hpp
+ * \brief  事件系统运行指标
+ *
+ * 定义 TANMI_METRICS 后启用，未定义时热路径上的记录代码不参与编译，查询接口返回空快照
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "TanmiHistogram.hpp"
+#include "TanmiEvent.hpp"
+
+//
+// TANMI_METRICS 改变 EventSystem 与消息处理器的布局及内联函数的定义，须对程序中所有翻译单元一致，
+// 使用CMake时以 TANMI_ENABLE_METRICS 选项为所有链接 Tanmi::EventSystem 的目标统一定义
+//
+#ifdef TANMI_METRICS
+#define TANMI_METRIC(...) __VA_ARGS__
+#ifdef _MSC_VER
+#pragma detect_mismatch("TANMI_METRICS", "1")
+#endif // _MSC_VER
+#else
+#define TANMI_METRIC(...)
+#ifdef _MSC_VER
+#pragma detect_mismatch("TANMI_METRICS", "0")
+#endif // _MSC_VER
+#endif // TANMI_METRICS
+
+namespace TanmiEngine
+{
+	/**
+	 * @brief 按线程分片的计数器，各线程写入不同缓存行，读取时求和
+	 */
+	class ShardedCounter
+	{
+	public:
+		static constexpr size_t SHARD_COUNT = 16;	///< 分片数量
+
+		ShardedCounter() = default;
+		ShardedCounter(const ShardedCounter&) = delete;				//< 禁止拷贝构造
+		ShardedCounter& operator=(const ShardedCounter&) = delete;	//< 禁止拷贝赋值
+
+		/**
+		 * @brief 增加计数
+		 *
+		 * @param n 增量
+		 */
+		void Add(unsigned long long n = 1) noexcept
+		{
+			shards[shardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 获取计数
+		 */
+		unsigned long long Value() const noexcept
+		{
+			unsigned long long sum = 0;
+			for (auto& shard : shards)
+				sum += shard.value.load(std::memory_order_relaxed);
+			return sum;
+		}
+		/**
+		 * @brief 清零
+		 */
+		void Reset() noexcept
+		{
+			for (auto& shard : shards)
+				shard.value.store(0, std::memory_order_relaxed);
+		}
+	private:
+		/**
+		 * @brief 当前线程使用的分片，首次调用时轮流分配
+		 */
+		static size_t shardIndex() noexcept
+		{
+			static std::atomic<size_t> next{ 0 };
+			thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+			return index;
+		}
+		struct alignas(64) Shard
+		{
+			std::atomic<unsigned long long> value{ 0 };
+		};
+		Shard shards[SHARD_COUNT];	//< 分片
+	};
+
+	/**
+	 * @brief 消息处理器指标快照，时长以纳秒为单位
+	 */
+	struct HandlerMetricsSnapshot
+	{
+		unsigned long long posted = 0;		///< 发送的消息数量
+		unsigned long long handled = 0;		///< 开始处理的消息数量
+		unsigned long long max_depth = 0;	///< 队列的最大深度
+		HistogramSnapshot queue_depth;		///< 发送时的队列深度
+		HistogramSnapshot wait_latency;		///< 消息自发送至开始处理的等待时长
+
+		/**
+		 * @brief 以JSON格式输出
+		 *
+		 * @return std::string JSON字符串
+		 */
+		std::string ToJson() const
+		{
+			return "{\"posted\":" + std::to_string(posted)
+				+ ",\"handled\":" + std::to_string(handled)
+				+ ",\"max_depth\":" + std::to_string(max_depth)
+				+ ",\"queue_depth\":" + queue_depth.ToJson()
+				+ ",\"wait_latency_ns\":" + wait_latency.ToJson() + "}";
+		}
+	};
+
+	/**
+	 * @brief 消息处理器指标
+	 */
+	class HandlerMetrics
+	{
+	public:
+		using Clock = std::chrono::steady_clock;	///< 计时使用的时钟
+
+		/**
+		 * @brief 记录一条消息的发送
+		 *
+		 * @param depth 发送后的队列深度
+		 */
+		void RecordPost(size_t depth) noexcept
+		{
+			posted.Add();
+			queue_depth.Record(depth);
+			auto cur = max_depth.load(std::memory_order_relaxed);
+			while (depth > cur && !max_depth.compare_exchange_weak(cur, depth, std::memory_order_relaxed));
+		}
+		/**
+		 * @brief 记录一条消息开始处理
+		 *
+		 * @param post_time 消息的发送时刻
+		 * @param now 开始处理的时刻
+		 */
+		void RecordWake(Clock::time_point post_time, Clock::time_point now) noexcept
+		{
+			handled.Add();
+			wait_latency.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - post_time).count());
+		}
+		/**
+		 * @brief 获取快照
+		 */
+		HandlerMetricsSnapshot Snapshot() const
+		{
+			HandlerMetricsSnapshot snapshot;
+			snapshot.posted = posted.Value();
+			snapshot.handled = handled.Value();
+			snapshot.max_depth = max_depth.load(std::memory_order_relaxed);
+			snapshot.queue_depth = queue_depth.Snapshot();
+			snapshot.wait_latency = wait_latency.Snapshot();
+			return snapshot;
+		}
+		/**
+		 * @brief 清空所有指标
+		 */
+		void Reset() noexcept
+		{
+			posted.Reset();
+			handled.Reset();
+			max_depth.store(0, std::memory_order_relaxed);
+			queue_depth.Reset();
+			wait_latency.Reset();
+		}
+	private:
+		ShardedCounter posted;							//< 发送的消息数量
+		ShardedCounter handled;							//< 处理的消息数量
+		std::atomic<unsigned long long> max_depth{ 0 };	//< 队列的最大深度
+		Histogram queue_depth;							//< 发送时的队列深度
+		Histogram wait_latency;							//< 等待时长
+	};
+
+	/**
+	 * @brief 单个事件的指标
+	 */
+	struct EventMetricsSnapshot
+	{
+		EventID id = 0;						///< 事件ID
+		unsigned long long fired = 0;		///< 触发并通过预处理的次数
+		unsigned long long listeners = 0;	///< 累计通知的监听器数量
+	};
+
+	/**
+	 * @brief 具名处理管线的指标快照
+	 */
+	struct RouteMetricsSnapshot
+	{
+		std::string name;						///< 管线名称
+		HandlerMetricsSnapshot handler;			///< 消息处理器指标
+		HandlerMetricsSnapshot handler_update;	///< 消息处理器（带有时间参数）指标
+	};
+
+	/**
+	 * @brief 事件系统指标快照
+	 */
+	struct EventSystemMetricsSnapshot
+	{
+		unsigned long long triggers = 0;	///< 触发调用次数
+		unsigned long long suppressed = 0;	///< 被预处理拦截的次数
+		unsigned long long not_found = 0;	///< 事件没有监听器的次数
+		unsigned long long posted = 0;		///< 发送的消息数量
+		std::vector<EventMetricsSnapshot> events;	///< 各事件指标
+		HandlerMetricsSnapshot handler;			///< 消息处理器指标
+		HandlerMetricsSnapshot handler_update;	///< 消息处理器（带有时间参数）指标
+		std::vector<RouteMetricsSnapshot> routes;	///< 各具名处理管线指标
+
+		/**
+		 * @brief 以JSON格式输出
+		 *
+		 * @return std::string JSON字符串
+		 */
+		std::string ToJson() const
+		{
+			std::string json = "{\"triggers\":" + std::to_string(triggers)
+				+ ",\"suppressed\":" + std::to_string(suppressed)
+				+ ",\"not_found\":" + std::to_string(not_found)
+				+ ",\"posted\":" + std::to_string(posted)
+				+ ",\"events\":[";
+			for (size_t i = 0; i < events.size(); ++i)
+			{
+				if (i != 0)
+					json += ",";
+				json += "{\"id\":" + std::to_string(events[i].id)
+					+ ",\"fired\":" + std::to_string(events[i].fired)
+					+ ",\"listeners\":" + std::to_string(events[i].listeners) + "}";
+			}
+			json += "],\"handler\":" + handler.ToJson()
+				+ ",\"handler_update\":" + handler_update.ToJson() + ",\"routes\":[";
+			for (size_t i = 0; i < routes.size(); ++i)
+			{
+				if (i != 0)
+					json += ",";
+				json += "{\"name\":\"" + routes[i].name
+					+ "\",\"handler\":" + routes[i].handler.ToJson()
+					+ ",\"handler_update\":" + routes[i].handler_update.ToJson() + "}";
+			}
+			json += "]}";
+			return json;
+		}
+	};
+}
\ No newline at end of file
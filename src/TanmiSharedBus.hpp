@@ -0,0 +1,620 @@
+#pragma once
+/*****************************************************************//**
+ * \file   TanmiSharedBus.hpp
+ * \brief  基于共享内存环形缓冲区的跨进程事件总线，仅支持Linux
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#ifdef __linux__
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "TanmiEventSystem.hpp"
+
+namespace TanmiEngine
+{
+	/**
+	 * @brief 总线上的一条事件，占一个缓存行
+	 */
+	struct alignas(64) SharedBusSlot
+	{
+		static constexpr size_t PAYLOAD_SIZE = 36;	///< 内联负载的最大字节数
+		static constexpr uint16_t UPDATE = 1;		///< 带有时间参数的触发
+		static constexpr uint64_t WRITING = 1ull << 63;	///< 写入中标记位，与序号+1一同存入seq
+
+		std::atomic<uint64_t> seq;		///< 序号+1，写入中附加WRITING标记
+		EventID id;						///< 事件ID（总线ID）
+		uint32_t origin;				///< 发送进程ID
+		double ms;						///< 时间参数
+		uint16_t flags;					///< 标志位
+		uint16_t size;					///< 负载字节数
+		std::byte payload[PAYLOAD_SIZE];	///< 内联负载
+	};
+	static_assert(sizeof(SharedBusSlot) == 64);
+
+	/**
+	 * @brief 当前线程是否正在将总线上的事件重新触发至本进程，期间导出监听器不再写回总线
+	 */
+	inline bool& SharedBusInjecting()
+	{
+		thread_local bool injecting = false;
+		return injecting;
+	}
+
+	/**
+	 * @brief 读取的事件
+	 */
+	struct SharedBusEntry
+	{
+		EventID id = 0;			///< 事件ID（总线ID）
+		uint32_t origin = 0;	///< 发送进程ID
+		double ms = 0;			///< 时间参数
+		uint16_t flags = 0;		///< 标志位
+		uint16_t size = 0;		///< 负载字节数
+		std::byte payload[SharedBusSlot::PAYLOAD_SIZE];	///< 内联负载
+	};
+
+	/**
+	 * @brief 共享内存中的总线头
+	 */
+	struct SharedBusHeader
+	{
+		static constexpr uint64_t MAGIC = 0x3153554244484E54ull;	///< "TNHDBUS1"
+
+		uint64_t magic;							///< 标识
+		uint32_t version;						///< 格式版本
+		uint32_t slot_size;						///< 单个槽位字节数
+		uint64_t capacity;						///< 槽位数量，为2的幂
+		alignas(64) std::atomic<uint64_t> cursor;	///< 已分配的序号，独占缓存行
+		char padding[56];						///< 填充
+	};
+
+	/**
+	 * @brief 跨进程事件总线
+	 *
+	 * 同一主机的多个进程映射同一块POSIX共享内存，其中为固定容量的广播环形缓冲区：
+	 * 发送方以一次原子加法取得序号后写入对应槽位，每个接收方各自维护读取位置。
+	 * 总线不提供反压，落后超过容量的接收方会丢失事件并计数
+	 */
+	class SharedEventBus
+	{
+	public:
+		SharedEventBus() = default;
+		SharedEventBus(const SharedEventBus&) = delete;				//< 禁止拷贝构造
+		SharedEventBus& operator=(const SharedEventBus&) = delete;	//< 禁止拷贝赋值
+		~SharedEventBus()
+		{
+			Close();
+		}
+		/**
+		 * @brief 创建总线，已存在的同名总线被重置
+		 *
+		 * @param name 共享内存名称，以'/'开头
+		 * @param capacity 槽位数量，向上取整为2的幂
+		 * @return true 创建成功
+		 * @return false 创建或映射失败
+		 */
+		bool Create(const std::string& name, size_t capacity)
+		{
+			Close();
+			capacity = std::bit_ceil(capacity < 2 ? 2 : capacity);
+			size_t bytes = sizeof(SharedBusHeader) + capacity * sizeof(SharedBusSlot);
+			int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+			if (fd < 0)
+				return false;
+			if (::ftruncate(fd, (off_t)bytes) != 0 || map(fd, bytes) == false)
+			{
+				::close(fd);
+				return false;
+			}
+			::close(fd);
+			header->magic = SharedBusHeader::MAGIC;
+			header->version = 1;
+			header->slot_size = sizeof(SharedBusSlot);
+			header->capacity = capacity;
+			header->cursor.store(0, std::memory_order_release);
+			mask = capacity - 1;
+			return true;
+		}
+		/**
+		 * @brief 连接至已创建的总线
+		 *
+		 * @param name 共享内存名称
+		 * @return true 连接成功
+		 * @return false 总线不存在或格式不符
+		 */
+		bool Attach(const std::string& name)
+		{
+			Close();
+			int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+			if (fd < 0)
+				return false;
+			struct stat st;
+			if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SharedBusHeader) || map(fd, st.st_size) == false)
+			{
+				::close(fd);
+				return false;
+			}
+			::close(fd);
+			if (header->magic != SharedBusHeader::MAGIC || header->slot_size != sizeof(SharedBusSlot)
+				|| sizeof(SharedBusHeader) + header->capacity * sizeof(SharedBusSlot) > size)
+			{
+				Close();
+				return false;
+			}
+			mask = header->capacity - 1;
+			return true;
+		}
+		/**
+		 * @brief 断开总线，不删除共享内存
+		 */
+		void Close()
+		{
+			if (base != nullptr)
+				::munmap(base, size);
+			base = nullptr;
+			header = nullptr;
+			slots = nullptr;
+		}
+		/**
+		 * @brief 删除共享内存，已连接的进程不受影响
+		 *
+		 * @param name 共享内存名称
+		 */
+		static bool Unlink(const std::string& name)
+		{
+			return ::shm_unlink(name.c_str()) == 0;
+		}
+		/**
+		 * @brief 是否已连接
+		 */
+		bool IsOpen() const
+		{
+			return base != nullptr;
+		}
+		/**
+		 * @brief 发送事件
+		 *
+		 * @param id 事件ID（总线ID）
+		 * @param payload 内联负载，不超过 SharedBusSlot::PAYLOAD_SIZE 字节
+		 * @param ms 时间参数
+		 * @param update 是否为带有时间参数的触发
+		 * @return true 发送成功
+		 * @return false 未连接或负载过大
+		 *
+		 * 槽位以CAS占用：上一圈的写入方尚未完成时等待其完成（超时视为其已退出并接管），
+		 * 槽位已被更新一圈的事件占用时本事件视为已被覆盖，直接返回
+		 */
+		bool Publish(EventID id, std::span<const std::byte> payload = {}, double ms = 0, bool update = false)
+		{
+			if (base == nullptr || payload.size() > SharedBusSlot::PAYLOAD_SIZE)
+				return false;
+			uint64_t index = header->cursor.fetch_add(1, std::memory_order_relaxed);
+			SharedBusSlot& slot = slots[index & mask];
+			if (claim(slot, index) == false)
+				return true;
+			// 写入中标记先于内容可见，使正在读取该槽位的接收方放弃本次读取
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.id = id;
+			slot.origin = pid;
+			slot.ms = ms;
+			slot.flags = update ? SharedBusSlot::UPDATE : 0;
+			slot.size = (uint16_t)payload.size();
+			if (payload.empty() == false)
+				std::memcpy(slot.payload, payload.data(), payload.size());
+			slot.seq.store(index + 1, std::memory_order_release);
+			return true;
+		}
+		/**
+		 * @brief 获取下一个待分配的序号，新的接收方由此开始读取，未连接时为0
+		 */
+		uint64_t Cursor() const
+		{
+			if (base == nullptr)
+				return 0;
+			return header->cursor.load(std::memory_order_acquire);
+		}
+		/**
+		 * @brief 读取结果
+		 */
+		enum class ReadResult
+		{
+			Ok,		///< 读取成功
+			Empty,	///< 暂无新事件
+			Lost,	///< 读取位置已被覆盖，读取位置跳至最早的可读事件
+		};
+		/**
+		 * @brief 读取一条事件
+		 *
+		 * @param cursor 读取位置，成功或丢失时更新
+		 * @param entry 读取的事件
+		 * @param lost 丢失时累加丢失的事件数量
+		 * @return ReadResult 读取结果，未连接时为 Empty
+		 */
+		ReadResult Read(uint64_t& cursor, SharedBusEntry& entry, uint64_t& lost) const
+		{
+			if (base == nullptr)
+				return ReadResult::Empty;
+			const SharedBusSlot& slot = slots[cursor & mask];
+			uint64_t seq = slot.seq.load(std::memory_order_acquire);
+			if (seq == cursor + 1)
+			{
+				entry.id = slot.id;
+				entry.origin = slot.origin;
+				entry.ms = slot.ms;
+				entry.flags = slot.flags;
+				entry.size = slot.size <= SharedBusSlot::PAYLOAD_SIZE ? slot.size : 0;
+				std::memcpy(entry.payload, slot.payload, entry.size);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (slot.seq.load(std::memory_order_relaxed) == seq)
+				{
+					++cursor;
+					return ReadResult::Ok;
+				}
+			}
+			else if (seq <= cursor)
+			{
+				// 尚未写入，或发送方正在写入
+				if (Cursor() <= cursor + header->capacity)
+					return ReadResult::Empty;
+			}
+			uint64_t head = Cursor();
+			uint64_t oldest = head > header->capacity ? head - header->capacity : 0;
+			if (oldest <= cursor)
+				return ReadResult::Empty;
+			lost += oldest - cursor;
+			cursor = oldest;
+			return ReadResult::Lost;
+		}
+	private:
+		static constexpr int MAX_CLAIM_SPIN = 1 << 16;	//< 等待上一圈写入方完成的最大自旋次数
+
+		/**
+		 * @brief 占用槽位，成功后seq带有写入中标记
+		 *
+		 * @param slot 槽位
+		 * @param index 待写入的序号
+		 * @return true 占用成功
+		 * @return false 槽位已被更新一圈的事件占用
+		 */
+		bool claim(SharedBusSlot& slot, uint64_t index)
+		{
+			uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+			int spin = 0;
+			while (true)
+			{
+				if ((seq & ~SharedBusSlot::WRITING) >= index + 1)
+					return false;
+				if ((seq & SharedBusSlot::WRITING) && ++spin < MAX_CLAIM_SPIN)
+				{
+					CpuRelax();
+					seq = slot.seq.load(std::memory_order_relaxed);
+					continue;
+				}
+				if (slot.seq.compare_exchange_weak(seq, (index + 1) | SharedBusSlot::WRITING, std::memory_order_relaxed))
+					return true;
+			}
+		}
+		/**
+		 * @brief 映射共享内存
+		 */
+		bool map(int fd, size_t bytes)
+		{
+			void* addr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (addr == MAP_FAILED)
+				return false;
+			base = (char*)addr;
+			size = bytes;
+			header = (SharedBusHeader*)base;
+			slots = (SharedBusSlot*)(base + sizeof(SharedBusHeader));
+			return true;
+		}
+
+		char* base = nullptr;				//< 映射区域
+		size_t size = 0;					//< 映射区域字节数
+		SharedBusHeader* header = nullptr;	//< 总线头
+		SharedBusSlot* slots = nullptr;		//< 槽位
+		uint64_t mask = 0;					//< 槽位下标掩码
+		uint32_t pid = (uint32_t)::getpid();	//< 当前进程ID
+	};
+
+	/**
+	 * @brief 总线导出监听器，绑定至需要跨进程发送的事件
+	 *
+	 * 配合 SharedBusMessageHandler / SharedBusMessageHandlerUpdate 使用时，事件在触发线程上直接写入总线，
+	 * 不经过本地消息队列；配合普通消息处理器使用时在处理线程上写入
+	 *
+	 * 由 SharedBusReceiver 重新触发的事件不会再次导出，以免同时导出与接收同一事件的进程间往返；
+	 * 该判断依赖触发线程，因此这类进程须使用总线消息处理器
+	 */
+	class SharedBusExporter : public Listener
+	{
+	public:
+		explicit SharedBusExporter(std::shared_ptr<SharedEventBus> _bus) :bus(std::move(_bus))
+		{}
+		/**
+		 * @brief 设置本地事件ID对应的总线ID，未设置的事件以本地ID发送，须在绑定事件前设置
+		 *
+		 * @param local 本地事件ID
+		 * @param remote 总线ID
+		 */
+		void MapEvent(EventID local, EventID remote)
+		{
+			idMap[local] = remote;
+		}
+		/**
+		 * @brief 将事件写入总线
+		 *
+		 * @param id 本地事件ID
+		 * @param ms 时间参数
+		 * @param update 是否为带有时间参数的触发
+		 */
+		void Export(EventID id, double ms, bool update)
+		{
+			if (SharedBusInjecting())
+				return;
+			auto it = idMap.find(id);
+			bus->Publish(it == idMap.end() ? id : it->second, {}, ms, update);
+		}
+		virtual void WakeEvent(const EventID event)
+		{
+			Export(event, 0, false);
+		}
+		virtual void WakeEventUpdate(const EventID event, double ms)
+		{
+			Export(event, ms, true);
+		}
+	private:
+		std::shared_ptr<SharedEventBus> bus;			//< 总线
+		std::unordered_map<EventID, EventID> idMap;		//< 事件ID映射，<本地ID, 总线ID>
+	};
+
+	/**
+	 * @brief 发往导出监听器的消息直接写入总线的消息处理器
+	 */
+	class SharedBusMessageHandler : public MessageHandler
+	{
+	public:
+		explicit SharedBusMessageHandler(std::shared_ptr<SharedBusExporter> _exporter) :exporter(std::move(_exporter))
+		{}
+		virtual void Post(EventID id, std::shared_ptr<Listener> cilent)
+		{
+			if (cilent.get() == exporter.get())
+				exporter->Export(id, 0, false);
+			else
+				MessageHandler::Post(id, std::move(cilent));
+		}
+		virtual void Post(EventID id, std::shared_ptr<Listener> cilent, std::shared_ptr<TriggerCompletion> completion)
+		{
+			if (cilent.get() == exporter.get())
+			{
+				exporter->Export(id, 0, false);
+				completion->Done();
+			}
+			else
+			{
+				MessageHandler::Post(id, std::move(cilent), std::move(completion));
+			}
+		}
+		virtual void PostBatch(std::shared_ptr<Listener> cilent, std::span<const EventID> events)
+		{
+			if (cilent.get() == exporter.get())
+			{
+				for (auto id : events)
+					exporter->Export(id, 0, false);
+			}
+			else
+			{
+				MessageHandler::PostBatch(std::move(cilent), events);
+			}
+		}
+	private:
+		std::shared_ptr<SharedBusExporter> exporter;	//< 导出监听器
+	};
+
+	/**
+	 * @brief 发往导出监听器的消息直接写入总线的消息处理器（带有时间参数）
+	 */
+	class SharedBusMessageHandlerUpdate : public MessageHandlerUpdate
+	{
+	public:
+		explicit SharedBusMessageHandlerUpdate(std::shared_ptr<SharedBusExporter> _exporter) :exporter(std::move(_exporter))
+		{}
+		virtual void Post(EventID id, std::shared_ptr<Listener> cilent, double ms)
+		{
+			if (cilent.get() == exporter.get())
+				exporter->Export(id, ms, true);
+			else
+				MessageHandlerUpdate::Post(id, std::move(cilent), ms);
+		}
+		virtual void Post(EventID id, std::shared_ptr<Listener> cilent, double ms, std::shared_ptr<TriggerCompletion> completion)
+		{
+			if (cilent.get() == exporter.get())
+			{
+				exporter->Export(id, ms, true);
+				completion->Done();
+			}
+			else
+			{
+				MessageHandlerUpdate::Post(id, std::move(cilent), ms, std::move(completion));
+			}
+		}
+	private:
+		std::shared_ptr<SharedBusExporter> exporter;	//< 导出监听器
+	};
+
+	/**
+	 * @brief 总线接收器，将其他进程发送的事件重新触发至本进程的事件系统
+	 *
+	 * 本进程发送的事件被忽略；事件ID映射与负载回调须在开始接收前设置
+	 */
+	class SharedBusReceiver
+	{
+	public:
+		using PayloadHandler = std::function<void(EventID, std::span<const std::byte>)>;	///< 负载回调，参数为本地事件ID与负载
+
+		/**
+		 * @brief 构造函数，从总线当前位置开始接收
+		 *
+		 * 总线尚未连接时，自连接后首次 Poll 时的位置开始接收
+		 * @param _bus 总线
+		 * @param _eventSystem 事件系统
+		 */
+		SharedBusReceiver(std::shared_ptr<SharedEventBus> _bus, EventSystem& _eventSystem = EventSystem::Instance())
+			:bus(std::move(_bus)), eventSystem(_eventSystem)
+		{
+			attached = bus != nullptr && bus->IsOpen();
+			cursor = attached ? bus->Cursor() : 0;
+		}
+		~SharedBusReceiver()
+		{
+			Stop();
+		}
+		/**
+		 * @brief 设置总线ID对应的本地事件ID
+		 *
+		 * @param remote 总线ID
+		 * @param local 本地事件ID
+		 */
+		void MapEvent(EventID remote, EventID local)
+		{
+			idMap[remote] = local;
+		}
+		/**
+		 * @brief 设置是否仅接收已映射的事件
+		 *
+		 * @param only true表示丢弃未映射的事件，false表示以总线ID触发
+		 */
+		void SetMappedOnly(bool only)
+		{
+			mappedOnly = only;
+		}
+		/**
+		 * @brief 设置负载回调，带有负载的事件在触发前调用
+		 */
+		void SetPayloadHandler(PayloadHandler handler)
+		{
+			payloadHandler = std::move(handler);
+		}
+		/**
+		 * @brief 处理总线上的新事件
+		 *
+		 * @param max 最多处理的事件数量
+		 * @return size_t 处理的事件数量，总线未连接时为0
+		 */
+		size_t Poll(size_t max = SIZE_MAX)
+		{
+			if (bus == nullptr || bus->IsOpen() == false)
+				return 0;
+			if (attached == false)
+			{
+				cursor = bus->Cursor();
+				attached = true;
+			}
+			SharedBusEntry entry;
+			size_t count = 0;
+			uint32_t self = (uint32_t)::getpid();
+			uint64_t lostCount = 0;
+			while (count < max)
+			{
+				auto result = bus->Read(cursor, entry, lostCount);
+				if (result == SharedEventBus::ReadResult::Empty)
+					break;
+				if (result == SharedEventBus::ReadResult::Lost)
+					continue;
+				++count;
+				if (entry.origin == self)
+					continue;
+				EventID id = entry.id;
+				auto it = idMap.find(id);
+				if (it != idMap.end())
+					id = it->second;
+				else if (mappedOnly)
+					continue;
+				if (entry.size != 0 && payloadHandler)
+					payloadHandler(id, std::span<const std::byte>(entry.payload, entry.size));
+				SharedBusInjecting() = true;
+				if (entry.flags & SharedBusSlot::UPDATE)
+					eventSystem.TriggerEventUpdate(id, entry.ms);
+				else
+					eventSystem.TriggerEvent(id);
+				SharedBusInjecting() = false;
+			}
+			if (lostCount != 0)
+				lost.fetch_add(lostCount, std::memory_order_relaxed);
+			return count;
+		}
+		/**
+		 * @brief 启动接收线程，无新事件时先自旋，再让出，最后短暂休眠
+		 */
+		void Start()
+		{
+			if (worker.joinable())
+				return;
+			exit.store(false, std::memory_order_relaxed);
+			worker = std::thread([this]()
+				{
+					int idle = 0;
+					while (!exit.load(std::memory_order_relaxed))
+					{
+						if (Poll() != 0)
+						{
+							idle = 0;
+							continue;
+						}
+						++idle;
+						if (idle < 1000)
+							continue;
+						else if (idle < 2000)
+							std::this_thread::yield();
+						else
+							std::this_thread::sleep_for(std::chrono::microseconds(50));
+					}
+				});
+		}
+		/**
+		 * @brief 停止接收线程
+		 */
+		void Stop()
+		{
+			exit.store(true, std::memory_order_relaxed);
+			if (worker.joinable())
+				worker.join();
+		}
+		/**
+		 * @brief 获取因落后而丢失的事件数量
+		 */
+		uint64_t Lost() const
+		{
+			return lost.load(std::memory_order_relaxed);
+		}
+	private:
+		std::shared_ptr<SharedEventBus> bus;		//< 总线
+		EventSystem& eventSystem;					//< 事件系统
+		uint64_t cursor = 0;						//< 读取位置
+		bool attached = false;						//< 读取位置是否已取自已连接的总线
+		std::unordered_map<EventID, EventID> idMap;	//< 事件ID映射，<总线ID, 本地ID>
+		bool mappedOnly = false;					//< 是否仅接收已映射的事件
+		PayloadHandler payloadHandler;				//< 负载回调
+		std::atomic<uint64_t> lost{ 0 };			//< 丢失的事件数量
+		std::atomic<bool> exit{ false };			//< 退出标志
+		std::thread worker;							//< 接收线程
+	};
+}
+#endif // __linux__
\ No newline at end of file
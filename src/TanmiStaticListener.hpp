@@ -0,0 +1,196 @@
+#pragma once
+/*****************************************************************//**
+ * \file   TanmiStaticListener.hpp
+ * \brief  静态分发的监听器
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <iostream>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "TanmiListener.hpp"
+
+namespace TanmiEngine
+{
+	/**
+	 * @brief 静态监听器组异常基类。
+	 */
+	class StaticListenerException : public std::exception
+	{
+	public:
+		virtual const char* what() const throw ()
+		{
+			return "::Expection Static Listener Exception basic";
+		}
+	};
+	/**
+	 * @brief 监听器下标越界异常类。
+	 */
+	class StaticListenerOutOfRangeException : public StaticListenerException
+	{
+	public:
+		virtual const char* what() const throw ()
+		{
+			return "::Expection index_out_of_range";
+		}
+	};
+
+	/**
+	 * @brief 静态监听器基类（CRTP），响应函数为非虚函数
+	 *
+	 * 派生类按需隐藏 WakeEvent 与 WakeEventUpdate，未隐藏的响应函数为空操作
+	 * @tparam Derived 派生类
+	 */
+	template<typename Derived>
+	class StaticListener
+	{
+	public:
+		/**
+		 * @brief 事件响应函数
+		 *
+		 * @param event 事件ID
+		 */
+		void WakeEvent(const EventID event)
+		{}
+		/**
+		 * @brief 事件响应函数
+		 *
+		 * @param event 事件ID
+		 * @param ms    事件发生所经过的时间（以毫秒为单位）
+		 */
+		void WakeEventUpdate(const EventID event, double ms)
+		{}
+	};
+
+	/**
+	 * @brief 静态监听器概念
+	 */
+	template<typename T>
+	concept StaticListenerBase = std::is_base_of_v<StaticListener<T>, T> && requires(T & t, EventID id, double ms)
+	{
+		t.WakeEvent(id);
+		t.WakeEventUpdate(id, ms);
+	};
+
+	/**
+	 * @brief 同类型静态监听器组
+	 *
+	 * 组内监听器连续存储，组本身作为一个监听器绑定事件；每次事件仅产生一条消息与一次虚函数调用，
+	 * 组内以非虚调用依次唤醒各成员，编译器可内联成员的响应函数。
+	 * 成员的响应函数在持有组锁时被调用，其中不可调用本组的任何成员函数（Emplace、Remove、Size等），否则死锁；
+	 * 需增删成员时应记录下来，在响应函数之外执行
+	 * @tparam T 静态监听器类型
+	 */
+	template<StaticListenerBase T>
+	class StaticListenerGroup : public Listener
+	{
+	public:
+		/**
+		 * @brief 构造并加入一个监听器
+		 *
+		 * @param pram 监听器构造参数
+		 * @return size_t 监听器在组内的下标
+		 */
+		template<typename... P>
+		size_t Emplace(P&&... pram)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			members.emplace_back(std::forward<P>(pram)...);
+			return members.size() - 1;
+		}
+		/**
+		 * @brief 移除监听器，末尾的监听器移至其位置
+		 *
+		 * @param index 监听器下标
+		 * @return size_t 移动前末尾监听器的下标，即原下标失效的监听器；下标越界时为 SIZE_MAX
+		 */
+		size_t Remove(size_t index)
+		{
+			try
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				if (index >= members.size())
+					throw StaticListenerOutOfRangeException();
+				size_t last = members.size() - 1;
+				if (index != last)
+					members[index] = std::move(members[last]);
+				members.pop_back();
+				return last;
+			}
+			catch (StaticListenerException& e)
+			{
+				std::cout << "\n::StaticListenerGroup::Remove()" << e.what() << std::endl;
+			}
+			return (std::numeric_limits<size_t>::max)();
+		}
+		/**
+		 * @brief 预留容量
+		 *
+		 * @param count 监听器数量
+		 */
+		void Reserve(size_t count)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			members.reserve(count);
+		}
+		/**
+		 * @brief 获取监听器数量
+		 */
+		size_t Size()
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			return members.size();
+		}
+		/**
+		 * @brief 在持有组锁时访问所有监听器，func 中不可调用本组的成员函数
+		 *
+		 * @param func 以 std::span<T> 为参数的函数
+		 */
+		template<typename F>
+		void Access(F&& func)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			func(std::span<T>(members));
+		}
+
+		virtual void WakeEvent(const EventID event)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			for (auto& member : members)
+				member.WakeEvent(event);
+		}
+		virtual void WakeEventUpdate(const EventID event, double ms)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			for (auto& member : members)
+				member.WakeEventUpdate(event, ms);
+		}
+		virtual void WakeEventBatch(std::span<const EventID> events)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			for (auto event : events)
+			{
+				for (auto& member : members)
+					member.WakeEvent(event);
+			}
+		}
+		virtual void WakeEventUpdateBatch(std::span<const EventID> events, std::span<const double> ms)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			for (size_t i = 0; i < events.size(); ++i)
+			{
+				for (auto& member : members)
+					member.WakeEventUpdate(events[i], ms[i]);
+			}
+		}
+	private:
+		std::vector<T> members;	//< 连续存储的监听器
+		std::mutex mtx;			//< 互斥锁
+	};
+}
\ No newline at end of file
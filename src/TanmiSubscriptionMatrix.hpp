@@ -0,0 +1,147 @@
+#pragma once
+/*****************************************************************//**
+ * \file   TanmiSubscriptionMatrix.hpp
+ * \brief  监听器×事件订阅位矩阵
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+#include "TanmiListener.hpp"
+#include "TanmiMemory.hpp"
+
+namespace TanmiEngine
+{
+	/**
+	 * @brief 订阅位矩阵，每个事件一行，每个监听器占一列
+	 *
+	 * 由事件列表整体重建，多个事件的订阅者并集通过按行OR求得，支持AVX2/SSE2时使用向量指令
+	 */
+	class SubscriptionMatrix
+	{
+	public:
+		/**
+		 * @brief 设置矩阵使用的内存资源，已有内容迁移至新资源
+		 *
+		 * @param resource 内存资源
+		 */
+		void SetMemoryResource(std::pmr::memory_resource* resource)
+		{
+			RebindResource(listeners, resource);
+			RebindResource(rows, resource);
+			RebindResource(bits, resource);
+			RebindResource(slots, resource);
+		}
+		/**
+		 * @brief 由事件列表重建矩阵，已失效的监听器被忽略
+		 *
+		 * @param eventList 事件列表，<事件ID, 监听器指针>
+		 */
+		void Rebuild(const std::pmr::multimap<EventID, std::weak_ptr<Listener>>& eventList)
+		{
+			listeners.clear();
+			rows.clear();
+			slots.clear();
+			for (auto& e : eventList)
+			{
+				auto listener = e.second.lock();
+				if (listener == nullptr)
+					continue;
+				if (slots.emplace(listener.get(), listeners.size()).second)
+					listeners.push_back(e.second);
+				rows.emplace(e.first, 0);
+			}
+			// 每行按4个64位字对齐，便于AVX2整块处理
+			stride = (listeners.size() + 255) / 256 * 4;
+			bits.assign(rows.size() * stride, 0);
+			size_t row = 0;
+			for (auto& r : rows)
+				r.second = row++;
+			for (auto& e : eventList)
+			{
+				auto listener = e.second.lock();
+				if (listener == nullptr)
+					continue;
+				size_t slot = slots[listener.get()];
+				bits[rows[e.first] * stride + slot / 64] |= 1ull << (slot % 64);
+			}
+		}
+		/**
+		 * @brief 获取每行的64位字数
+		 */
+		size_t Stride() const
+		{
+			return stride;
+		}
+		/**
+		 * @brief 获取事件所在行
+		 *
+		 * @param id 事件ID
+		 * @return const uint64_t* 行首，事件无订阅者时为nullptr
+		 */
+		const uint64_t* Row(EventID id) const
+		{
+			auto it = rows.find(id);
+			return it == rows.end() ? nullptr : bits.data() + it->second * stride;
+		}
+		/**
+		 * @brief 将一行OR至累加行
+		 *
+		 * @param acc 累加行，长度为 Stride()
+		 * @param row 事件所在行
+		 */
+		void Accumulate(uint64_t* acc, const uint64_t* row) const
+		{
+			size_t i = 0;
+#if defined(__AVX2__)
+			for (; i + 4 <= stride; i += 4)
+			{
+				__m256i a = _mm256_loadu_si256((const __m256i*)(acc + i));
+				__m256i b = _mm256_loadu_si256((const __m256i*)(row + i));
+				_mm256_storeu_si256((__m256i*)(acc + i), _mm256_or_si256(a, b));
+			}
+#elif defined(__SSE2__) || defined(_M_X64)
+			for (; i + 2 <= stride; i += 2)
+			{
+				__m128i a = _mm_loadu_si128((const __m128i*)(acc + i));
+				__m128i b = _mm_loadu_si128((const __m128i*)(row + i));
+				_mm_storeu_si128((__m128i*)(acc + i), _mm_or_si128(a, b));
+			}
+#endif
+			for (; i < stride; ++i)
+				acc[i] |= row[i];
+		}
+		/**
+		 * @brief 判断某列在行中是否置位
+		 */
+		static bool Test(const uint64_t* row, size_t slot)
+		{
+			return (row[slot / 64] >> (slot % 64)) & 1;
+		}
+		/**
+		 * @brief 获取列对应的监听器
+		 *
+		 * @param slot 列
+		 * @return std::shared_ptr<Listener> 监听器，已失效时为空
+		 */
+		std::shared_ptr<Listener> GetListener(size_t slot) const
+		{
+			return listeners[slot].lock();
+		}
+	private:
+		std::pmr::vector<std::weak_ptr<Listener>> listeners;	//< 各列对应的监听器
+		std::pmr::unordered_map<EventID, size_t> rows;		//< 事件所在行，<事件ID, 行号>
+		std::pmr::vector<uint64_t> bits;					//< 位矩阵
+		std::pmr::unordered_map<Listener*, size_t> slots;	//< 重建时的监听器列号，<监听器, 列号>
+		size_t stride = 0;								//< 每行的64位字数
+	};
+}
\ No newline at end of file
@@ -0,0 +1,319 @@
+#pragma once
+/*****************************************************************//**
+ * \file   TanmiTrace.hpp
+ * \brief  事件分发追踪，导出为Chrome trace JSON
+ *
+ * 定义 TANMI_TRACE 后启用，未定义时追踪点不参与编译
+ *
+ * \author tanmika
+ * \date   October 2026
+ *********************************************************************/
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define TANMI_TRACE_TSC
+#endif
+
+#include "TanmiEvent.hpp"
+
+namespace TanmiEngine
+{
+	/**
+	 * @brief 追踪记录类型
+	 */
+	enum class TraceType : uint32_t
+	{
+		TriggerBegin,	///< 触发开始
+		TriggerEnd,		///< 触发结束
+		Post,			///< 消息发送，流起点
+		Dequeue,		///< 消息出队，流终点
+		ListenerBegin,	///< 监听器处理开始
+		ListenerEnd,	///< 监听器处理结束
+	};
+
+	/**
+	 * @brief 追踪记录，32字节
+	 */
+	struct TraceRecord
+	{
+		uint64_t timestamp;	///< 时间戳（计数器周期）
+		uint64_t flow;		///< 流ID，将消息的发送与处理相连
+		EventID id;			///< 事件ID
+		TraceType type;		///< 记录类型
+		uint64_t reserved;	///< 保留
+	};
+
+	/**
+	 * @brief 事件分发追踪器
+	 *
+	 * 每个线程写入各自的环形缓冲区，记录仅需读取时间戳计数器与一次写入；缓冲区写满后覆盖最早的记录。
+	 * 导出时应先停止追踪，写入中的缓冲区导出结果可能包含不完整的记录
+	 */
+	class Tracer
+	{
+	public:
+		static constexpr size_t BUFFER_SIZE = 1 << 16;	///< 每个线程缓冲区的记录数量，须为2的幂
+
+		/**
+		 * @brief 获取Tracer实例引用
+		 */
+		static Tracer& Instance()
+		{
+			static Tracer tracer;
+			return tracer;
+		}
+		/**
+		 * @brief 开启或停止追踪
+		 *
+		 * @param enable 是否开启
+		 */
+		void Enable(bool enable)
+		{
+			enabled.store(enable, std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 是否正在追踪
+		 */
+		bool IsEnabled() const
+		{
+			return enabled.load(std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 写入一条记录
+		 *
+		 * @param type 记录类型
+		 * @param id 事件ID
+		 * @param flow 流ID
+		 */
+		static void Record(TraceType type, EventID id, uint64_t flow = 0)
+		{
+			Tracer& tracer = Instance();
+			if (tracer.enabled.load(std::memory_order_relaxed) == false)
+				return;
+			ThreadBuffer* buffer = tracer.threadBuffer();
+			size_t index = buffer->head.load(std::memory_order_relaxed);
+			buffer->records[index & (BUFFER_SIZE - 1)] = TraceRecord{ Now(), flow, id, type, 0 };
+			buffer->head.store(index + 1, std::memory_order_release);
+		}
+		/**
+		 * @brief 生成新的流ID，高位为线程序号，无需同步
+		 */
+		static uint64_t NewFlowId()
+		{
+			Tracer& tracer = Instance();
+			ThreadBuffer* buffer = tracer.threadBuffer();
+			return ((uint64_t)buffer->tid << 40) | ++buffer->flow;
+		}
+		/**
+		 * @brief 读取时间戳计数器
+		 */
+		static uint64_t Now()
+		{
+#ifdef TANMI_TRACE_TSC
+			return __rdtsc();
+#else
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+		}
+		/**
+		 * @brief 清空所有线程的记录
+		 */
+		void Clear()
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			for (auto& buffer : buffers)
+				buffer->head.store(0, std::memory_order_relaxed);
+		}
+		/**
+		 * @brief 导出为Chrome trace JSON，可由 chrome://tracing 或 Perfetto UI 打开
+		 *
+		 * 触发与监听器处理导出为区间，消息的发送与处理之间以流箭头相连
+		 * @return std::string JSON字符串
+		 */
+		std::string ExportChromeJson()
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			double ns_per_tick = nsPerTick();
+			std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+			bool first = true;
+			auto append = [&](const std::string& e)
+				{
+					if (first == false)
+						json += ",\n";
+					json += e;
+					first = false;
+				};
+			for (auto& buffer : buffers)
+			{
+				std::string tid = std::to_string(buffer->tid);
+				append("{\"ph\":\"M\",\"pid\":1,\"tid\":" + tid + ",\"name\":\"thread_name\",\"args\":{\"name\":\"thread " + tid + "\"}}");
+				size_t head = buffer->head.load(std::memory_order_acquire);
+				size_t begin = head > BUFFER_SIZE ? head - BUFFER_SIZE : 0;
+				for (size_t i = begin; i < head; ++i)
+				{
+					const TraceRecord& r = buffer->records[i & (BUFFER_SIZE - 1)];
+					std::string ts = std::to_string((double)(r.timestamp - base_tick) * ns_per_tick / 1000.0);
+					std::string common = ",\"pid\":1,\"tid\":" + tid + ",\"ts\":" + ts;
+					std::string event = std::to_string(r.id);
+					switch (r.type)
+					{
+					case TraceType::TriggerBegin:
+						append("{\"ph\":\"B\",\"cat\":\"trigger\",\"name\":\"Trigger " + event + "\"" + common + "}");
+						break;
+					case TraceType::TriggerEnd:
+						append("{\"ph\":\"E\"" + common + "}");
+						break;
+					case TraceType::Post:
+						append("{\"ph\":\"s\",\"cat\":\"message\",\"name\":\"Message " + event + "\",\"id\":" + std::to_string(r.flow) + common + "}");
+						break;
+					case TraceType::Dequeue:
+						append("{\"ph\":\"f\",\"bp\":\"e\",\"cat\":\"message\",\"name\":\"Message " + event + "\",\"id\":" + std::to_string(r.flow) + common + "}");
+						break;
+					case TraceType::ListenerBegin:
+						append("{\"ph\":\"B\",\"cat\":\"listener\",\"name\":\"Wake " + event + "\"" + common + "}");
+						break;
+					case TraceType::ListenerEnd:
+						append("{\"ph\":\"E\"" + common + "}");
+						break;
+					}
+				}
+			}
+			json += "]}";
+			return json;
+		}
+		/**
+		 * @brief 导出为Chrome trace JSON文件
+		 *
+		 * @param path 文件路径
+		 * @return true 写入成功
+		 * @return false 写入失败
+		 */
+		bool WriteChromeJson(const std::string& path)
+		{
+			std::ofstream file(path, std::ios::binary);
+			if (!file)
+				return false;
+			file << ExportChromeJson();
+			return (bool)file;
+		}
+	private:
+		/**
+		 * @brief 线程缓冲区
+		 */
+		struct ThreadBuffer
+		{
+			std::vector<TraceRecord> records = std::vector<TraceRecord>(BUFFER_SIZE);	//< 环形缓冲区
+			std::atomic<size_t> head{ 0 };	//< 已写入的记录总数
+			uint32_t tid = 0;				//< 线程序号
+			uint64_t flow = 0;				//< 本线程已生成的流ID数量
+		};
+		/**
+		 * @brief 线程对缓冲区的占用，线程退出时归还
+		 */
+		struct BufferLease
+		{
+			ThreadBuffer* buffer = nullptr;	//< 占用的缓冲区
+			~BufferLease()
+			{
+				if (buffer != nullptr)
+					Instance().release(buffer);
+			}
+		};
+
+		Tracer() :base_tick(Now()), base_time(std::chrono::steady_clock::now())
+		{}
+		/**
+		 * @brief 获取当前线程的缓冲区，首次调用时优先复用已退出线程的缓冲区，没有时创建
+		 */
+		ThreadBuffer* threadBuffer()
+		{
+			thread_local BufferLease lease;
+			if (lease.buffer == nullptr)
+				lease.buffer = acquire();
+			return lease.buffer;
+		}
+		/**
+		 * @brief 取出空闲的缓冲区，没有时创建
+		 *
+		 * 复用的缓冲区沿用线程序号与流ID计数，流ID保持唯一；原线程的记录保留至被覆盖
+		 */
+		ThreadBuffer* acquire()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				if (freeBuffers.empty() == false)
+				{
+					ThreadBuffer* buffer = freeBuffers.back();
+					freeBuffers.pop_back();
+					return buffer;
+				}
+			}
+			auto created = std::make_unique<ThreadBuffer>();
+			std::lock_guard<std::mutex> lock(mtx);
+			created->tid = (uint32_t)buffers.size() + 1;
+			ThreadBuffer* buffer = created.get();
+			buffers.push_back(std::move(created));
+			return buffer;
+		}
+		/**
+		 * @brief 归还已退出线程的缓冲区
+		 */
+		void release(ThreadBuffer* buffer)
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			freeBuffers.push_back(buffer);
+		}
+		/**
+		 * @brief 以构造至今的计数器周期与真实时间换算每周期纳秒数
+		 */
+		double nsPerTick() const
+		{
+			uint64_t ticks = Now() - base_tick;
+			double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - base_time).count();
+			return ticks == 0 ? 1.0 : ns / ticks;
+		}
+
+		std::atomic<bool> enabled{ false };					//< 是否正在追踪
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;	//< 所有线程的缓冲区，线程退出后保留以便导出，数量不超过同时存活的线程数
+		std::vector<ThreadBuffer*> freeBuffers;				//< 已退出线程归还的缓冲区，由此后首次记录的线程复用
+		std::mutex mtx;										//< 互斥锁，保护缓冲区列表
+		uint64_t base_tick;									//< 构造时的计数器
+		std::chrono::steady_clock::time_point base_time;	//< 构造时的真实时间
+	};
+
+	/**
+	 * @brief 在作用域开始与结束时写入一对记录
+	 */
+	class TraceScope
+	{
+	public:
+		TraceScope(TraceType _begin, TraceType _end, EventID _id, uint64_t flow = 0) :end(_end), id(_id)
+		{
+			Tracer::Record(_begin, id, flow);
+		}
+		~TraceScope()
+		{
+			Tracer::Record(end, id);
+		}
+	private:
+		TraceType end;	//< 结束记录类型
+		EventID id;		//< 事件ID
+	};
+}
+
+#ifdef TANMI_TRACE
+#define TANMI_TRACE_POINT(...) __VA_ARGS__
+#else
+#define TANMI_TRACE_POINT(...)
+#endif // TANMI_TRACE
\ No newline at end of file